@@ -45,7 +45,8 @@ typedef struct {
 // limits
 enum {
     QS_MIN_VERSION      = 660,  // minimum required version
-    QS_RECORD_SIZE_MAX  = 512,  // max QS record size [bytes]
+    QS_RECORD_SIZE_MAX  = 512,  // default max QS record size [bytes]
+    QS_RECORD_SIZE_LIMIT = 0x100000, // limit of QSPY_configRecordSize()
     QS_LINE_LEN_MAX     = 65528, // max length of a QSPY line [chars]
     QS_FNAME_LEN_MAX    = 256,  // max length of filenames [chars]
     QS_SEQ_LIST_LEN_MAX = 1024, // max length of the Seq list [chars]
@@ -56,6 +57,136 @@ enum {
 typedef int (*QSPY_CustParseFun)(QSpyRecord * const me);
 typedef void (*QSPY_resetFun)(void);
 
+// pointer to the function for printing the last line of output
+typedef void (*QSPY_PrintLnFun)(void);
+
+// typed decoding of QS records ..............................................
+enum {
+    QSPY_REC_FIELDS_MAX = 32, // max number of decoded fields of a record
+};
+
+enum QSpyFieldType {
+    QSPY_FLD_UINT, // unsigned integer (QSpyRecord_getUint32/64())
+    QSPY_FLD_INT,  // signed integer (QSpyRecord_getInt32/64())
+    QSPY_FLD_STR,  // zero-terminated string (QSpyRecord_getStr())
+    QSPY_FLD_MEM,  // memory block (QSpyRecord_getMem())
+};
+
+// decoded field of a QS record
+typedef struct {
+    uint8_t  type; // the type of the field (enum QSpyFieldType)
+    uint8_t  size; // size of the field (of one element/char for MEM/STR)
+    uint16_t num;  // number of elements (QSPY_FLD_MEM)
+    union {
+        uint64_t u;
+        int64_t  i;
+        char const    *str; // points into the record being processed
+        uint8_t const *mem; // points into the record being processed
+    } val;
+} QSpyField;
+
+// decoded QS record, filled in by the QSpyRecord_get*() facilities
+// in the order of the fields in the record (the first QSPY_REC_FIELDS_MAX)
+typedef struct {
+    uint8_t   rec;       // the record-ID
+    uint8_t   seq;       // the sequence number of the record
+    bool      hasTstamp; // the record carries the timestamp
+    uint8_t   nFld;      // number of the decoded fields in fld[]
+    uint32_t  tstamp;    // the timestamp (valid if hasTstamp)
+    uint64_t  tstamp64;  // the timestamp unwrapped to 64 bits (monotonic)
+    uint64_t  wallNs;    // host wall-clock time of tstamp64 [ns since 1970]
+                         // (0 without the clock fit, QSPY_configClockFit())
+    QSpyField fld[QSPY_REC_FIELDS_MAX];
+} QSpyRecData;
+
+// pointer to the callback function for observing the decoded QS records
+typedef void (*QSPY_RecordFun)(QSpyRecData const *data);
+
+// schema of the predefined QS records: the fields of a record in order,
+// each with the source of its size and the dictionary for its value.
+// This is the single source of truth for the table-driven decoder (used
+// when no text is rendered) and for the binary exporters.
+enum {
+    QSPY_SCHEMA_FIELDS_MAX = 8,   // max number of fields of a schema
+    QSPY_SCHEMA_RECS       = 100, // number of the predefined records
+};
+
+// size source of a schema field
+enum QSpySchemaSize {
+    QSPY_SZ_NONE,   // no field
+    QSPY_SZ_TSTAMP, // the record timestamp (QSpyConfig.tstampSize)
+    QSPY_SZ_OBJ,    // object pointer (QSpyConfig.objPtrSize)
+    QSPY_SZ_FUN,    // function pointer (QSpyConfig.funPtrSize)
+    QSPY_SZ_SIG,    // signal (QSpyConfig.sigSize)
+    QSPY_SZ_EVT,    // event size (QSpyConfig.evtSize)
+    QSPY_SZ_QCTR,   // queue counter (QSpyConfig.queueCtrSize)
+    QSPY_SZ_PCTR,   // pool counter (QSpyConfig.poolCtrSize)
+    QSPY_SZ_TCTR,   // time event counter (QSpyConfig.tevtCtrSize)
+    QSPY_SZ_U8,     // 1 byte
+    QSPY_SZ_U16,    // 2 bytes
+    QSPY_SZ_U32,    // 4 bytes
+    QSPY_SZ_STR,    // zero-terminated string (variable size)
+};
+
+// dictionary to resolve the value of a schema field against
+enum QSpySchemaDict {
+    QSPY_DICT_NONE,
+    QSPY_DICT_OBJ,
+    QSPY_DICT_FUN,
+    QSPY_DICT_SIG, // together with the object of the record
+};
+
+typedef struct {
+    uint8_t size; // source of the size (enum QSpySchemaSize)
+    uint8_t dict; // dictionary of the value (enum QSpySchemaDict)
+} QSpySchemaField;
+
+typedef struct {
+    uint8_t         nFld; // number of fields (0 for no schema)
+    QSpySchemaField fld[QSPY_SCHEMA_FIELDS_MAX];
+} QSpyRecSchema;
+
+// layout of a predefined record for the current configuration,
+// computed from the schema when the configuration changes
+typedef struct {
+    uint8_t len; // total size of the fields (0 for variable-size records)
+    uint8_t offs[QSPY_SCHEMA_FIELDS_MAX]; // offsets of the fields
+    uint8_t size[QSPY_SCHEMA_FIELDS_MAX]; // sizes of the fields
+} QSpyRecLayout;
+
+// reader of a little-endian field of a given size from the record
+typedef uint64_t (*QSPY_ReadFun)(uint8_t const *pos);
+
+// decoding plan of a user record, compiled from the format bytes of the
+// last record with the same ID (its "format signature"). A following
+// record with the same signature is decoded by the plan without parsing
+// the format bytes. Only the records of fixed-size elements have plans.
+enum {
+    QSPY_USR_RECS        = 256 - QSPY_SCHEMA_RECS, // number of user records
+    QSPY_USR_PLAN_FIELDS = 24, // max fields of a plan (format bytes incl.)
+};
+
+typedef struct {
+    uint8_t offs; // offset of the field after the timestamp
+    uint8_t size; // size of the field [bytes]
+    uint8_t kind; // QSPY_FLD_UINT/QSPY_FLD_INT, or QSPY_PLAN_FMT
+    uint8_t fmt;  // the expected format byte (QSPY_PLAN_FMT)
+} QSpyPlanField;
+
+enum {
+    QSPY_PLAN_FMT = 0xFFU, // plan field kind of a format byte
+};
+
+typedef struct {
+    uint8_t       len;  // length of the record after the timestamp (0: none)
+    uint8_t       nFld; // number of the plan fields
+    QSpyPlanField fld[QSPY_USR_PLAN_FIELDS];
+} QSpyUsrPlan;
+
+// returns the schema of the given predefined record
+// (or NULL for the records without a schema)
+QSpyRecSchema const *QSPY_getRecSchema(uint8_t rec);
+
 void        QSpyRecord_init     (QSpyRecord * const me,
                                  uint8_t const *start, uint32_t tot_len);
 QSpyStatus  QSpyRecord_OK       (QSpyRecord * const me);
@@ -68,6 +199,12 @@ uint8_t const *QSpyRecord_getMem(QSpyRecord * const me,
                                  uint8_t size,
                                  uint32_t *pNum);
 
+// does the record end the current session (QS_TARGET_INFO of a target
+// reset or of a changed target configuration)? The dictionaries are
+// discarded when such a record is processed. Must be called before the
+// record is processed, because it compares the record with QSPY_conf.
+bool QSpyRecord_isSessionEnd(QSpyRecord const * const me);
+
 // QSPY configuration and high-level interface ...............................
 // QSPY configuration parameters. @sa QSPY_config()
 typedef struct {
@@ -95,6 +232,16 @@ void QSPY_config(QSpyConfig const *config,
                  QSPY_CustParseFun custParseFun);
 void QSPY_configTxReset(QSPY_resetFun txResetFun);
 void QSPY_configMatFile(void *matFile);
+void QSPY_configText(bool enable); // enable/disable rendering of text lines
+void QSPY_configOnRecord(QSPY_RecordFun onRecordFun);
+// enable/disable the fit of the target timestamps to the host clock
+void QSPY_configClockFit(bool enable);
+
+// set the max size of the received records (default QS_RECORD_SIZE_MAX,
+// up to QS_RECORD_SIZE_LIMIT), returns QSPY_ERROR if the size is invalid
+// or cannot be allocated. NOTE: the text lines of large records are still
+// truncated at QS_LINE_LEN_MAX.
+QSpyStatus QSPY_configRecordSize(uint32_t size);
 
 void QSPY_reset(void);
 void QSPY_parse(uint8_t const *buf, uint32_t nBytes);
@@ -136,6 +283,11 @@ char const* QSPY_tstampStr(void);
 
 void QSPY_onPrintLn(void); // callback to print the last line of output
 
+// prints the last line of output through the current parser's output hook
+// (QSPY_onPrintLn() by default), unless the text rendering is disabled.
+// @sa QSpyParser.printLnFun, QSPY_configText()
+void QSPY_printLn(void);
+
 // prints information message to the QSPY output (without sending it to FE)
 void QSPY_printInfo(void);
 
@@ -175,34 +327,48 @@ enum QSpyGroups_plus {
 // returns the "group" of a given QS record-ID
 int QSPY_getGroup(int recId);
 
-// last output generated
-extern QSPY_LastOutput QSPY_output;
+// returns the name of a given QS record-ID (e.g., "QS_QF_PUBLISH")
+char const *QSPY_getRecName(int recId);
+
+// last output generated (by the current parser, see QSPY_currParser)
+#define QSPY_output (QSPY_currParser->output)
 
 // beginning of QSPY line to print
-extern char const * const QSPY_line;
-
-#define SNPRINTF_LINE(format_, ...) do {                       \
-    int n_ = SNPRINTF_S(&QSPY_output.buf[QS_LINE_OFFSET],      \
-                (QS_LINE_LEN_MAX - QS_LINE_OFFSET),            \
-                format_,  __VA_ARGS__);                        \
-    if ((0 < n_) && (n_ < QS_LINE_LEN_MAX - QS_LINE_OFFSET)) { \
-        QSPY_output.len = n_;                                  \
-    }                                                          \
-    else {                                                     \
-        QSPY_output.len = QS_LINE_LEN_MAX - QS_LINE_OFFSET;    \
-    }                                                          \
+#define QSPY_line   (&QSPY_output.buf[QS_LINE_OFFSET])
+
+// is the rendering of text lines enabled (for the current parser)?
+#define QSPY_TEXT_ON()  (QSPY_currParser->textOn)
+
+// NOTE: the SNPRINTF_LINE()/SNPRINTF_APPEND() arguments are evaluated
+// only when the text rendering is enabled, so they must be free of
+// side effects (in particular, they must not consume the record fields).
+#define SNPRINTF_LINE(format_, ...) do {                           \
+    if (QSPY_TEXT_ON()) {                                          \
+        int n_ = SNPRINTF_S(&QSPY_output.buf[QS_LINE_OFFSET],      \
+                    (QS_LINE_LEN_MAX - QS_LINE_OFFSET),            \
+                    format_,  __VA_ARGS__);                        \
+        if ((0 < n_) && (n_ < QS_LINE_LEN_MAX - QS_LINE_OFFSET)) { \
+            QSPY_output.len = n_;                                  \
+        }                                                          \
+        else {                                                     \
+            QSPY_output.len = QS_LINE_LEN_MAX - QS_LINE_OFFSET;    \
+        }                                                          \
+    }                                                              \
 } while (0)
 
 #define SNPRINTF_APPEND(format_, ...) do {                                 \
-    int n_ = SNPRINTF_S(&QSPY_output.buf[QS_LINE_OFFSET + QSPY_output.len],\
-                (QS_LINE_LEN_MAX - QS_LINE_OFFSET - QSPY_output.len),      \
-                format_, __VA_ARGS__);                                     \
-    if ((0 < n_)                                                           \
-        && (n_ < QS_LINE_LEN_MAX - QS_LINE_OFFSET - QSPY_output.len)) {    \
-        QSPY_output.len += n_;                                             \
-    }                                                                      \
-    else {                                                                 \
-        QSPY_output.len = QS_LINE_LEN_MAX - QS_LINE_OFFSET;                \
+    if (QSPY_TEXT_ON()) {                                                  \
+        int n_ = SNPRINTF_S(                                               \
+                    &QSPY_output.buf[QS_LINE_OFFSET + QSPY_output.len],    \
+                    (QS_LINE_LEN_MAX - QS_LINE_OFFSET - QSPY_output.len),  \
+                    format_, __VA_ARGS__);                                 \
+        if ((0 < n_)                                                       \
+            && (n_ < QS_LINE_LEN_MAX - QS_LINE_OFFSET - QSPY_output.len)) {\
+            QSPY_output.len += n_;                                         \
+        }                                                                  \
+        else {                                                             \
+            QSPY_output.len = QS_LINE_LEN_MAX - QS_LINE_OFFSET;            \
+        }                                                                  \
     }                                                                      \
 } while (0)
 
@@ -213,21 +379,50 @@ extern char const * const QSPY_line;
     } else (void)0
 
 // Dictionaries ..............................................................
+// NOTE: the entries are stored in the order of insertion in sto[] and
+// are looked up through open-addressing hash indexes into sto[]:
+// idx[] by the key and nameIdx[] by the name. The stale nameIdx[] slots
+// (left by renamed entries) are purged when the name index is rebuilt.
+// The index slots are tagged with the dictionary generation, so that
+// a reset only needs to start a new generation.
+// The tables are allocated on the heap and grow on demand up to the
+// maximum capacity. The names are interned in the dictionary arena,
+// which never moves them.
+typedef struct DictArenaBlock DictArenaBlock;
+
+typedef struct {
+    DictArenaBlock* blocks; // chain of arena blocks, the current one first
+    uint32_t        used;   // bytes used in the current block
+} DictArena;
+
 typedef struct {
-    KeyType key;
-    char    name[QS_DNAME_LEN_MAX];
+    uint32_t gen; // generation of the slot (empty if not the current one)
+    int      n;   // sto[] index + 1
+} DictSlot;
+
+typedef struct {
+    KeyType     key;
+    char const* name; // interned in the dictionary arena
 } DictEntry;
 
 typedef struct {
-    DictEntry  notFound;
+    char       notFound[QS_DNAME_LEN_MAX];
     DictEntry* sto;
-    int        capacity;
+    int        capacity; // current capacity of sto[]
+    int        maxCapacity; // capacity limit
     int        entries;
     int        keySize;
+    DictSlot*  idx;     // hash index by the key
+    DictSlot*  nameIdx; // hash index by the name
+    uint32_t   idxMask; // number of idx[]/nameIdx[] slots - 1 (power of 2)
+    uint32_t   gen;     // current generation of the index slots
+    uint32_t   nameUsed; // number of used nameIdx[] slots
+    uint32_t   dropped;  // entries dropped at the capacity limit
+    DictArena  arena;
 } Dictionary;
 
-void Dictionary_ctor(Dictionary* const me,
-    DictEntry* sto, uint32_t capacity);
+void Dictionary_ctor(Dictionary* const me, uint32_t maxCapacity);
+void Dictionary_xtor(Dictionary* const me);
 void Dictionary_config(Dictionary* const me, int keySize);
 char const* Dictionary_at(Dictionary* const me, unsigned idx);
 void Dictionary_put(Dictionary* const me, KeyType key, char const* name);
@@ -235,23 +430,33 @@ char const* Dictionary_get(Dictionary* const me, KeyType key, char* buf);
 int Dictionary_find(Dictionary* const me, KeyType key);
 KeyType Dictionary_findKey(Dictionary* const me, char const* name);
 void Dictionary_reset(Dictionary* const me);
+void Dictionary_sort(Dictionary* const me);
 
 typedef struct {
-    SigType sig;
-    ObjType obj;
-    char    name[QS_DNAME_LEN_MAX];
+    SigType     sig;
+    ObjType     obj;
+    char const* name; // interned in the dictionary arena
+    int         next; // next entry with the same sig (sto[] index + 1)
 } SigDictEntry;
 
 typedef struct {
-    SigDictEntry  notFound;
+    char          notFound[QS_DNAME_LEN_MAX];
     SigDictEntry* sto;
-    int           capacity;
+    int           capacity; // current capacity of sto[]
+    int           maxCapacity; // capacity limit
     int           entries;
     int           ptrSize;
+    DictSlot*     idx;     // hash index of the first entry with a sig
+    DictSlot*     nameIdx; // hash index by the name
+    uint32_t      idxMask; // number of idx[]/nameIdx[] slots - 1
+    uint32_t      gen;     // current generation of the index slots
+    uint32_t      nameUsed; // number of used nameIdx[] slots
+    uint32_t      dropped;  // entries dropped at the capacity limit
+    DictArena     arena;
 } SigDictionary;
 
-void SigDictionary_ctor(SigDictionary* const me,
-    SigDictEntry* sto, uint32_t capacity);
+void SigDictionary_ctor(SigDictionary* const me, uint32_t maxCapacity);
+void SigDictionary_xtor(SigDictionary* const me);
 void SigDictionary_config(SigDictionary* const me, int ptrSize);
 void SigDictionary_put(SigDictionary* const me,
     SigType sig, ObjType obj, char const* name);
@@ -262,7 +467,663 @@ int SigDictionary_find(SigDictionary* const me,
 SigType SigDictionary_findSig(SigDictionary* const me,
                              char const* name, ObjType obj);
 void SigDictionary_reset(SigDictionary* const me);
+void SigDictionary_sort(SigDictionary* const me);
 void QSPY_resetAllDictionaries(void);
+void QSPY_sortAllDictionaries(void); // sort by the keys (before writing)
+uint32_t QSPY_getDictDropped(void); // entries dropped by all dictionaries
+
+// QSPY parser ...............................................................
+// dictionary capacity limits of a parser
+enum {
+    QSPY_FUN_DICT_MAX  = 0x100000,
+    QSPY_OBJ_DICT_MAX  = 0x100000,
+    QSPY_USR_DICT_MAX  = 28,   // 128 - QS_USER
+    QSPY_SIG_DICT_MAX  = 0x100000,
+    QSPY_ENUM_DICT_MAX = 256,
+    QSPY_ENUM_GROUPS   = 8,
+};
+
+// batch of the output lines and decoded records ............................
+// A batch is filled by QSPY_parseBatch() instead of calling the output
+// hook once per line, so that the host can write out the whole batch at
+// once. The parsing stops at a frame boundary as soon as the batch
+// has no room left for another record (see QSPY_BATCH_REC_LINES/TEXT).
+enum {
+    QSPY_BATCH_REC_LINES = 4,    // lines reserved for the next record
+    QSPY_BATCH_REC_TEXT  = 4096, // text reserved for the next record [chars]
+};
+
+// line of output in a batch
+typedef struct {
+    int         rec;  // the corresponding QS record ID
+    int         type; // the type of the output (enum QSPY_LastOutputType)
+    int         len;  // the length of the line
+    char const *line; // the zero-terminated line (in the batch text[])
+} QSpyBatchLine;
+
+typedef struct {
+    // storage provided by the caller...
+    QSpyBatchLine *lines;    // output lines (NULL for no text rendering)
+    uint32_t       maxLines;
+    char          *text;     // text of the lines and of the record fields
+    uint32_t       textSize;
+    QSpyRecData   *recs;     // decoded records (NULL if not collected)
+    uint32_t       maxRecs;
+
+    // filled in by QSPY_parseBatch()...
+    uint32_t nLines;  // number of lines in lines[]
+    uint32_t textLen; // used part of text[]
+    uint32_t nRecs;   // number of decoded records in recs[]
+    uint32_t nLost;   // lines/record fields that did not fit (truncated)
+} QSpyBatch;
+// NOTE: the string and memory fields of recs[] point into text[]. The
+// fields that did not fit (or without text[]) are stored empty: the
+// string as "" and the memory block with num == 0 (counted in nLost).
+
+void QSpyBatch_clear(QSpyBatch * const me); // empty the batch for re-use
+
+// decoder statistics ........................................................
+// The counters are updated by the parser for every record, whether or not
+// the text output is enabled. The rates are averaged over the periods of
+// QSPY_STATS_PERIOD milliseconds.
+enum {
+    QSPY_STATS_PERIOD = 1000, // period of the rate updates [ms]
+};
+
+typedef struct {
+    uint64_t recCount[256]; // healthy records by the record ID
+    uint64_t recBytes[256]; // un-escaped bytes of the records by the ID
+    uint64_t nBytes;     // raw (framed) bytes received
+    uint64_t nRecs;      // healthy records received
+    uint32_t nBadChksum; // records with bad checksum
+    uint32_t nDiscont;   // discontinuities of the sequence numbers
+    uint32_t nLost;      // records lost (inferred from the sequence gaps)
+    uint32_t nTooLong;   // records too long
+    uint32_t nTooShort;  // records too short
+
+    // rolling rates...
+    uint32_t byteRate;  // raw bytes per second
+    uint32_t recRate;   // records per second
+    uint64_t periodBeg; // beginning of the current period [ms]
+    uint64_t periodBytes; // nBytes at the beginning of the period
+    uint64_t periodRecs;  // nRecs at the beginning of the period
+} QSpyStats;
+
+// serialize the statistics (little-endian) into the payload of the
+// QSPY_STATS packet, returns the length of the payload (0 if no room):
+// u64 nBytes, u64 nRecs, u32 nBadChksum, u32 nDiscont, u32 nLost,
+// u32 nTooLong, u32 nTooShort, u32 byteRate, u32 recRate, u16 nIds,
+// and then nIds times: u8 recId, u64 count, u64 bytes
+uint32_t QSpyStats_pack(QSpyStats const * const me,
+                        uint8_t *buf, uint32_t size);
+
+// target clock of a stream ..................................................
+// The timestamps of the records are unwrapped to 64 bits, so that they
+// increase monotonically across the wrap-arounds of the target timer
+// (and across the target resets). A small step back (less than half of
+// the timer range) is taken as such and not as a wrap-around.
+// Optionally, the unwrapped timestamps are fitted linearly to the host
+// time of the reception (exponentially weighted over the last about
+// QSPY_CLOCK_FIT_WINDOW samples, one sample per the received buffer).
+enum {
+    QSPY_CLOCK_FIT_WINDOW = 1024, // samples of the clock fit
+};
+
+typedef struct {
+    uint64_t last64; // the last unwrapped timestamp
+    uint64_t epoch;  // start of the unwrapped timestamps after a reset
+    uint32_t last;   // the last raw timestamp
+    bool     valid;  // timestamp received since the (re)start
+
+    // linear fit: host [ns] = y0 + b*(tstamp64 - x0) + a ...
+    bool     fitOn;  // is the fit enabled?
+    bool     sample; // timestamp received in the current buffer
+    uint32_t nSamples; // number of the samples of the fit
+    uint64_t x0;     // origin of the target time [ticks]
+    uint64_t y0;     // origin of the host time [ns]
+    double   w;      // total weight of the samples
+    double   mx, my; // weighted means
+    double   cxx, cxy; // weighted co-moments
+    double   a, b;   // the fit (valid for nSamples > 1)
+} QSpyClock;
+
+// QSPY parser context: the framing state, the configuration and
+// the dictionaries of one target stream. Multiple parsers can be used
+// to decode multiple targets in one process. @sa QSpyParser_init()
+// NOTE: the dictionary tables are allocated on the heap and are released
+// by QSpyParser_xtor().
+typedef struct {
+    // framing state...
+    uint8_t *pos;    // position within the record
+    uint8_t  chksum; // running checksum of the record
+    uint8_t  esc;    // escape byte received
+    uint8_t  seq;    // sequence number of the last record
+    bool     isJustStarted; // no record received yet
+    uint8_t *record;     // record being received (recordSto or heap)
+    uint32_t recordSize; // size of the record[] buffer
+    uint8_t  recordSto[QS_RECORD_SIZE_MAX]; // default record[] buffer
+
+    // configuration...
+    QSpyConfig        conf;
+    QSPY_CustParseFun custParseFun;
+    QSpyRecLayout     layout[QSPY_SCHEMA_RECS]; // for the current conf
+    QSPY_ReadFun      readFun[QSPY_SZ_STR];  // readers by the size source
+    uint8_t           readSize[QSPY_SZ_STR]; // sizes by the size source
+    QSpyUsrPlan       usrPlan[QSPY_USR_RECS]; // plans of the user records
+
+    // dictionaries...
+    Dictionary    funDict;
+    Dictionary    objDict;
+    Dictionary    usrDict;
+    SigDictionary sigDict;
+    Dictionary    enumDict[QSPY_ENUM_GROUPS];
+
+    QSPY_LastOutput output; // last output generated by this parser
+    QSPY_PrintLnFun printLnFun; // output hook (QSPY_onPrintLn() default)
+    bool            textOn;     // render the text lines? (true by default)
+
+    QSpyRecData     recData;     // decoded record being processed
+    QSPY_RecordFun  onRecordFun; // observer of the decoded records (or NULL)
+    QSpyBatch      *batch;       // batch being filled (or NULL)
+
+    QSpyStats stats; // decoder statistics @sa QSpyParser_getStats()
+    QSpyClock clock; // target clock of the stream
+
+    void *ctx; // application context (e.g., target ID), not used by QSPY
+} QSpyParser;
+
+void QSpyParser_init (QSpyParser * const me,
+                      QSpyConfig const *config,
+                      QSPY_CustParseFun custParseFun);
+void QSpyParser_reset(QSpyParser * const me);
+void QSpyParser_xtor (QSpyParser * const me);
+QSpyStatus QSpyParser_configRecordSize(QSpyParser * const me,
+                                       uint32_t size);
+// update the record layouts and the field readers after conf changes
+void QSpyParser_updateLayout(QSpyParser * const me);
+void QSpyParser_clone(QSpyParser * const me,
+                      QSpyParser const * const other);
+void QSpyParser_parse(QSpyParser * const me,
+                      uint8_t const *buf, uint32_t nBytes);
+uint32_t QSpyParser_parseBatch(QSpyParser * const me,
+                               QSpyBatch * const batch,
+                               uint8_t const *buf, uint32_t nBytes);
+// statistics of the parser with the rates brought up to date
+QSpyStats const *QSpyParser_getStats(QSpyParser * const me);
+void QSpyParser_resetStats(QSpyParser * const me);
+
+// parse into the batch with the current parser, returns the number of
+// bytes consumed (less than nBytes when the batch is full)
+uint32_t QSPY_parseBatch(QSpyBatch * const batch,
+                         uint8_t const *buf, uint32_t nBytes);
+QSpyStats const *QSPY_getStats(void); // of the current parser
+
+#if defined(_MSC_VER)
+#define QSPY_THREAD_LOCAL __declspec(thread)
+#elif defined(__cplusplus)
+#define QSPY_THREAD_LOCAL thread_local
+#else
+#define QSPY_THREAD_LOCAL _Thread_local
+#endif
+
+// the default parser used by the QSPY_config()/QSPY_parse() API
+extern QSpyParser QSPY_parser;
+
+// the parser currently processing records in the calling thread
+// NOTE: points to QSPY_parser, except within QSpyParser_parse()
+extern QSPY_THREAD_LOCAL QSpyParser *QSPY_currParser;
+
+// configuration and dictionaries of the current parser
+#define QSPY_conf        (QSPY_currParser->conf)
+#define QSPY_funDict     (QSPY_currParser->funDict)
+#define QSPY_objDict     (QSPY_currParser->objDict)
+#define QSPY_usrDict     (QSPY_currParser->usrDict)
+#define QSPY_sigDict     (QSPY_currParser->sigDict)
+#define QSPY_enumDict    (QSPY_currParser->enumDict)
+
+// QSPY decoding engine (thread-per-target) ..................................
+// The engine decodes N target streams on a pool of worker threads. Each
+// stream is served by one worker, so that the records of a stream are
+// decoded and delivered in order. The decoded records are delivered
+// through a lock-free multiple-producer single-consumer queue, in nodes
+// that QENG_recycle() returns to the pool of their worker for reuse.
+// All the retrieved records should be recycled before QENG_stop(), which
+// frees the pools. A record recycled after it is freed instead, but it
+// must not be recycled concurrently with QENG_stop().
+// The lines lost for the lack of memory are counted (QENG_getDropped()).
+
+// record decoded by the engine @sa QENG_get()
+typedef struct {
+    uint16_t    stream; // the target stream the record was decoded from
+    uint8_t     rec;    // QS record-ID
+    uint8_t     type;   // type of the output (enum QSPY_LastOutputType)
+    int         len;    // length of the line
+    char const *line;   // human-readable line of output (zero-terminated)
+} QENG_Rec;
+
+QSpyStatus  QENG_start(uint16_t nStreams, uint16_t nWorkers,
+                       QSpyConfig const *config,
+                       QSPY_CustParseFun custParseFun);
+void        QENG_stop(void);
+QSpyParser *QENG_getParser(uint16_t stream);
+QSpyStatus  QENG_post(uint16_t stream,
+                      uint8_t const *buf, uint32_t nBytes);
+QENG_Rec const *QENG_get(void);
+void        QENG_recycle(QENG_Rec const *rec);
+void        QENG_flush(void);
+uint32_t    QENG_getDropped(void);
+
+// offline decoding of a QS capture file in parallel. The decoded lines are
+// delivered to outFun() in the order of the capture, from the caller thread.
+// NOTE: the chunks are decoded by their own parsers (not QSPY_parser), so
+// the host-application outputs (the Matlab and Sequence files, the external
+// dictionaries of the -d option and the Tx-reset) are not produced. The
+// lines lost for the lack of memory are counted (QENG_getDropped()).
+typedef void (*QENG_OutFun)(QSpyBatchLine const *lines, uint32_t nLines,
+                            void *arg);
+QSpyStatus  QENG_decodeFile(char const *fName, uint16_t nWorkers,
+                            QSpyConfig const *config,
+                            QSPY_CustParseFun custParseFun,
+                            QENG_OutFun outFun, void *arg);
+
+// QSPY flight recorder ......................................................
+// The flight recorder keeps the last ringSize bytes of the raw (framed)
+// QS stream in memory without decoding them. Only the headers of the
+// frames are inspected, to keep the dictionary and target-info records
+// aside and to spot the trigger records (QS_ASSERT_FAIL and QS_TARGET_DONE
+// by default). A dump writes the time-stamped <prefix>YYMMDD_hhmmss.bin
+// and decodes it into the .txt file of the same name. QSpyFlightRec_put()
+// only notes the triggers (so it never blocks the reception of the
+// stream), and QSpyFlightRec_poll() performs the dump outside of the
+// receive path. The triggers until then are coalesced into one dump.
+enum {
+    QSPY_FLIGHT_STICKY_MAX = 1024*1024, // max size of the kept dictionaries
+    QSPY_FLIGHT_FNAME_LEN  = 256,       // max length of the dump file names
+};
+
+typedef struct {
+    uint8_t *ring;    // ring buffer of the raw stream
+    size_t   size;    // size of the ring[]
+    uint64_t total;   // total number of bytes put into the ring
+
+    uint8_t *sticky;     // frames of the dictionaries and target-info
+    size_t   stickyLen;
+    size_t   stickySize;
+
+    uint64_t frameBeg; // position of the current frame in the stream
+    uint8_t  hdr;      // number of the header bytes of the current frame
+    uint8_t  esc;      // escape byte received
+    uint8_t  rec;      // record ID of the current frame
+    uint32_t pending;  // triggers pending for the next dump (coalesced)
+    uint32_t trigMask[4]; // bitmask of the trigger record IDs
+
+    char const *prefix; // prefix (path) of the dump files
+    uint32_t nDumps;    // number of the dumps so far
+    char fName[QSPY_FLIGHT_FNAME_LEN]; // name of the last .bin file
+} QSpyFlightRec;
+
+QSpyStatus QSpyFlightRec_ctor(QSpyFlightRec * const me,
+                              size_t ringSize, char const *prefix);
+void QSpyFlightRec_xtor(QSpyFlightRec * const me);
+void QSpyFlightRec_configTrigger(QSpyFlightRec * const me,
+                                 uint8_t rec, bool on);
+void QSpyFlightRec_put(QSpyFlightRec * const me,
+                       uint8_t const *buf, uint32_t nBytes);
+// dump the ring (and decode it with the configuration of QSPY_currParser)
+QSpyStatus QSpyFlightRec_dump(QSpyFlightRec * const me);
+// dump the ring if any trigger is pending (e.g., on the idle timeout of
+// the main loop), returns QSPY_SUCCESS when nothing is pending
+QSpyStatus QSpyFlightRec_poll(QSpyFlightRec * const me);
+
+// QSPY analyzers ...........................................................
+// The analyzers keep state across the decoded records of one stream. They
+// are fed with the records by the application's observer (installed by
+// QSPY_configOnRecord()), so they work with or without the text output,
+// and use the unwrapped timestamps (QSpyRecData.tstamp64). The reports
+// are printed as QSPY info lines through the current parser.
+
+// HDR-style histogram: log-linear buckets with 2^QSPY_HIST_BITS buckets
+// for the values below 2^QSPY_HIST_BITS and 2^(QSPY_HIST_BITS-1) buckets
+// per every higher power of two, so that the reported values are within
+// 1/2^(QSPY_HIST_BITS-1) of the recorded ones. The counts are allocated
+// only up to the largest value recorded.
+enum {
+    QSPY_HIST_BITS = 6, // resolution of the buckets [bits]
+};
+
+typedef struct {
+    uint32_t *counts;  // counts of the buckets
+    uint32_t  nCounts; // number of the allocated buckets
+    uint64_t  total;   // number of the recorded values
+    uint64_t  min;     // the minimum recorded value
+    uint64_t  max;     // the maximum recorded value
+} QSpyHist;
+
+void     QSpyHist_ctor(QSpyHist * const me);
+void     QSpyHist_xtor(QSpyHist * const me);
+void     QSpyHist_record(QSpyHist * const me, uint64_t val);
+// value at the given percentile (0..100) or 0 for an empty histogram
+uint64_t QSpyHist_percentile(QSpyHist const * const me, double pct);
+
+// map of 64-bit keys to 32-bit values (open addressing)
+enum {
+    QSPY_MAP_NONE = 0xFFFFFFFFU, // no value (not a valid value)
+};
+
+typedef struct {
+    uint64_t *keys;
+    uint32_t *vals; // QSPY_MAP_NONE for the empty slots
+    uint32_t  mask; // number of the slots - 1 (power of 2)
+    uint32_t  n;    // number of the used slots
+} QSpyMap;
+
+void     QSpyMap_ctor(QSpyMap * const me);
+void     QSpyMap_xtor(QSpyMap * const me);
+uint32_t QSpyMap_get(QSpyMap const * const me, uint64_t key);
+bool     QSpyMap_put(QSpyMap * const me, uint64_t key, uint32_t val);
+void     QSpyMap_remove(QSpyMap * const me, uint64_t key);
+
+// event latency analyzer: matches the QS_QF_ACTIVE_POST(_LIFO) records to
+// the QS_QF_ACTIVE_GET(_LAST) and QS_QEP_DISPATCH records of every active
+// object and keeps per (AO, signal) the histograms of the post-to-dispatch
+// and the dispatch-to-completion latencies [target ticks]. The completion
+// of the RTC step is the next GET of the same AO, QS_SCHED_NEXT or
+// QS_SCHED_IDLE at the same preemption level, or QS_SCHED_RESTORE of the
+// level. The time of a step preempted (QS_SCHED_PREEMPT) until the
+// matching QS_SCHED_RESTORE is excluded. (Under QXK, a switch to an
+// extended thread is traced as QS_SCHED_NEXT, so it ends the step.)
+enum {
+    QSPY_LAT_POSTS_MAX = 4096, // max pending posts to an AO
+    QSPY_LAT_LEVELS    = 66,   // max preemption levels (priorities + 2)
+};
+
+typedef struct {
+    uint64_t ts;  // timestamp of the post
+    uint32_t sig; // the posted signal
+} QSpyLatPost;
+
+typedef struct {
+    uint64_t     ao;       // the active object
+    QSpyLatPost *posts;    // FIFO of the pending posts (ring buffer)
+    uint32_t     head;     // the oldest post in posts[]
+    uint32_t     nPosts;   // number of the pending posts
+    uint32_t     maxPosts; // capacity of posts[] (power of 2)
+    QSpyMap      sigHist;  // signal -> QSpyLatency.hist[] index
+    uint64_t     postTs;   // post of the event got (if hasPost)
+    uint32_t     getSig;   // signal of the event got (if hasGet)
+    bool         hasGet;   // event got and not dispatched yet
+    bool         hasPost;  // the post of the event got is known
+    uint32_t     busy;     // hist[] index + 1 of the RTC step (0: idle)
+    uint64_t     dispTs;   // timestamp of the dispatch (if busy)
+    uint64_t     paused;   // time the RTC step was preempted (if busy)
+    uint64_t     pauseTs;  // beginning of the preemption (if isPaused)
+    bool         isPaused; // the RTC step is preempted
+} QSpyLatAO;
+
+typedef struct {
+    uint64_t ao;
+    uint32_t sig;
+    QSpyHist post2disp; // post-to-dispatch latency
+    QSpyHist disp2done; // dispatch-to-completion latency
+} QSpyLatHist;
+
+typedef struct {
+    QSpyMap      aoIdx;   // AO -> aos[] index
+    QSpyLatAO   *aos;
+    uint32_t     nAos;
+    uint32_t     maxAos;
+    QSpyLatHist *hist;
+    uint32_t     nHist;
+    uint32_t     maxHist;
+    uint32_t     nBusy;      // number of the busy AOs
+    uint32_t     level;      // preemption level (QS_SCHED_PREEMPT nesting)
+    uint32_t     run[QSPY_LAT_LEVELS]; // aos[] index + 1 of the RTC step
+                                       // at every level (0: none)
+    uint32_t     nUnmatched; // events got without the matching post
+    uint32_t     nDropped;   // posts dropped (without the matching get)
+    bool         reportOnDone; // report at QS_TARGET_DONE (true by default)
+} QSpyLatency;
+
+void QSpyLatency_ctor(QSpyLatency * const me);
+void QSpyLatency_xtor(QSpyLatency * const me);
+void QSpyLatency_onRecord(QSpyLatency * const me, QSpyRecData const *data);
+void QSpyLatency_report(QSpyLatency const * const me);
+
+// queue occupancy tracker: follows the free-entry counters (nFree) and the
+// low-water marks (nMin) of the AO queues (QS_QF_ACTIVE_POST/GET...) and
+// of the raw event queues (QS_QF_EQUEUE_POST/GET...). The capacity of a
+// queue is estimated as the largest nFree seen. The time with nFree at or
+// below lowFree is accumulated and an alert is printed whenever nMin of
+// a queue drops to a new low at or below lowFree. Optionally, every sample
+// is exported to a file, either as CSV lines "tstamp,queue,nFree,nMin"
+// or as little-endian binary records {u64 tstamp, u64 queue, u16 nFree,
+// u16 nMin}.
+typedef struct {
+    uint64_t obj;     // the queue (the AO for the AO queues)
+    bool     isAO;    // is it an AO queue?
+    bool     valid;   // nFree known?
+    uint16_t nFree;   // the last number of the free entries
+    uint16_t nMin;    // the lowest nMin reported
+    uint16_t maxFree; // the largest nFree seen (estimated capacity)
+    uint16_t alertMin; // nMin of the last alert (or 0xFFFF)
+    uint32_t nPosts;
+    uint32_t nGets;
+    uint64_t lastTs;  // timestamp of the last sample
+    uint64_t firstTs; // timestamp of the first sample
+    uint64_t freeTime; // integral of nFree over time [entries*ticks]
+    uint64_t lowTime;  // time with nFree <= lowFree [ticks]
+} QSpyQueue;
+
+typedef struct {
+    QSpyMap    idx;  // queue -> queues[] index
+    QSpyQueue *queues;
+    uint32_t   nQueues;
+    uint32_t   maxQueues;
+    uint16_t   lowFree;  // the alert threshold of free entries (1 default)
+    void      *expFile;  // export of the samples (FILE*, or NULL)
+    bool       csv;      // export as CSV (or binary)?
+} QSpyQueues;
+
+void QSpyQueues_ctor(QSpyQueues * const me, uint16_t lowFree);
+void QSpyQueues_xtor(QSpyQueues * const me);
+void QSpyQueues_configExport(QSpyQueues * const me,
+                             void *expFile, bool csv);
+void QSpyQueues_onRecord(QSpyQueues * const me, QSpyRecData const *data);
+void QSpyQueues_report(QSpyQueues const * const me);
+
+// memory pool tracker: follows the free-block counters of the event pools
+// (QS_QF_MPOOL_GET/GET_ATTEMPT/PUT) and correlates every get with the
+// QS_QF_NEW(_ATTEMPT) record that follows it, to collect the distribution
+// of the event sizes allocated from each pool. The samples can be exported
+// as by QSpyQueues_configExport() (with the pool in place of the queue).
+typedef struct {
+    uint64_t obj;      // the pool
+    bool     valid;    // nFree known?
+    uint16_t nFree;    // the last number of the free blocks
+    uint16_t nMin;     // the lowest nMin reported
+    uint16_t maxFree;  // the largest nFree seen (estimated capacity)
+    uint32_t nGets;    // successful gets
+    uint32_t nFails;   // failed get attempts
+    uint32_t nPuts;
+    uint64_t lastTs;   // timestamp of the last sample
+    uint64_t firstTs;  // timestamp of the first sample
+    uint64_t freeTime; // integral of nFree over time [blocks*ticks]
+    QSpyHist evtSize;  // sizes of the events allocated from the pool
+} QSpyPool;
+
+typedef struct {
+    QSpyMap   idx;  // pool -> pools[] index
+    QSpyPool *pools;
+    uint32_t  nPools;
+    uint32_t  maxPools;
+    uint32_t  lastGet; // pools[] index + 1 of the preceding get (or 0)
+    void     *expFile; // export of the samples (FILE*, or NULL)
+    bool      csv;     // export as CSV (or binary)?
+} QSpyPools;
+
+void QSpyPools_ctor(QSpyPools * const me);
+void QSpyPools_xtor(QSpyPools * const me);
+void QSpyPools_configExport(QSpyPools * const me, void *expFile, bool csv);
+void QSpyPools_onRecord(QSpyPools * const me, QSpyRecData const *data);
+void QSpyPools_report(QSpyPools const * const me);
+// serialize the pools (little-endian) to follow the QSpyStats_pack()
+// payload in the QSPY_STATS packet, returns the length (0 if no room):
+// u16 nPools, and then nPools times: u64 pool, u16 capacity, u16 nFree,
+// u16 nMin, u32 nGets, u32 nFails, u16 max event size
+uint32_t QSpyPools_pack(QSpyPools const * const me,
+                        uint8_t *buf, uint32_t size);
+
+// event lifetime tracker: follows the dynamic events from the allocation
+// (QS_QF_NEW) to the recycling (QS_QF_GC) through QS_QF_NEW_REF,
+// QS_QF_DELETE_REF and QS_QF_GC_ATTEMPT. The QS records of the events
+// carry the signal, the pool and the reference counter, but not the event
+// pointer, so the events are tracked per signal and the recycled events
+// are matched to the oldest live events of the same signal (FIFO).
+// Reported are the lifetime histograms per signal, the live events older
+// than leakAge (leak suspects) and the reference counter anomalies
+// (recycling of an event with no live allocation of its signal or
+// a reference counter of a dynamic event at 0 when it should not be).
+enum {
+    QSPY_EVT_LIVE_MAX = 0x10000, // max tracked live events per signal
+};
+
+typedef struct {
+    uint32_t  sig;
+    uint8_t   pool;     // the pool of the recycled events (or 0)
+    uint64_t *allocTs;  // timestamps of the live events (ring buffer)
+    uint32_t  head;     // the oldest live event in allocTs[]
+    uint32_t  nLive;    // number of the live events
+    uint32_t  maxLive;  // capacity of allocTs[] (power of 2)
+    uint32_t  peakLive; // the largest number of the live events
+    uint32_t  nNew;
+    uint32_t  nGc;
+    QSpyHist  lifetime; // allocation to recycling [ticks]
+} QSpyEvtSig;
+
+typedef struct {
+    QSpyMap     idx;  // signal -> sigs[] index
+    QSpyEvtSig *sigs;
+    uint32_t    nSigs;
+    uint32_t    maxSigs;
+    uint32_t    nUnmatched;  // recycled without a live allocation
+    uint32_t    nRefErrors;  // reference counter anomalies
+    uint32_t    nDropped;    // live events dropped (over QSPY_EVT_LIVE_MAX)
+    uint64_t    lastTs;      // timestamp of the last record
+    uint64_t    leakAge;     // age of the leak suspects [ticks]
+} QSpyEvtLife;
+
+void QSpyEvtLife_ctor(QSpyEvtLife * const me, uint64_t leakAge);
+void QSpyEvtLife_xtor(QSpyEvtLife * const me);
+void QSpyEvtLife_onRecord(QSpyEvtLife * const me, QSpyRecData const *data);
+void QSpyEvtLife_report(QSpyEvtLife const * const me);
+
+// CPU load profiler: replays the scheduler records (QS_SCHED_NEXT/IDLE/
+// PREEMPT/RESTORE) and the ISR records (QS_QF_ISR_ENTRY/EXIT) to attribute
+// every tick between two consecutive records to the owner of the CPU:
+// the innermost ISR (by its priority), the task at the current priority,
+// or the idle loop (priority 0). The load is reported for every window of
+// the given length [ticks] (0: no windows) and summarized by
+// QSpyCpuLoad_report(), also at QS_TARGET_DONE.
+enum {
+    QSPY_CPU_ISR_NEST_MAX = 16, // max tracked ISR nesting
+    QSPY_CPU_WIN_GAP_MAX  = 16, // max windows reported for one record gap
+};
+
+typedef struct {
+    uint64_t busy;    // the time owning the CPU [ticks]
+    uint32_t nRuns;   // the number of times it got the CPU
+    uint32_t nPreempt; // the number of times it was preempted
+} QSpyCpuTime;
+
+typedef struct {
+    QSpyCpuTime task[256]; // per task priority (0: idle)
+    QSpyCpuTime isr[256];  // per ISR priority
+    uint64_t    beg;       // the beginning of the period
+    uint64_t    end;       // the end of the period (the last record)
+} QSpyCpuPeriod;
+
+typedef struct {
+    QSpyCpuPeriod total;   // the whole session
+    QSpyCpuPeriod win;     // the current window
+    uint64_t      window;  // the length of the windows [ticks] (0: none)
+    uint64_t      lastTs;  // timestamp of the last record
+    bool          started; // lastTs valid?
+    uint8_t       pri;     // the current task priority (0: idle)
+    uint8_t       nIsr;    // the current ISR nesting
+    uint8_t       isrPri[QSPY_CPU_ISR_NEST_MAX]; // the ISR priorities
+    uint32_t      nWins;   // the number of the windows reported
+    bool          reportOnDone; // report at QS_TARGET_DONE (true by default)
+} QSpyCpuLoad;
+
+void QSpyCpuLoad_ctor(QSpyCpuLoad * const me, uint64_t window);
+void QSpyCpuLoad_xtor(QSpyCpuLoad * const me);
+void QSpyCpuLoad_onRecord(QSpyCpuLoad * const me, QSpyRecData const *data);
+void QSpyCpuLoad_report(QSpyCpuLoad const * const me);
+
+// critical section analyzer: pairs the QS_QF_CRIT_ENTRY/EXIT and the
+// QS_QF_INT_DISABLE/ENABLE records (by the reported nesting) and keeps
+// the histograms of the durations of the outermost sections, the counts
+// of the sections by the record preceding them, and the worst section
+// with the records before, inside and after it. The sections longer than
+// the given limit [ticks] (0: no limit) are reported as errors.
+enum {
+    QSPY_CRIT_CTX = 8, // records of the context kept before/inside/after
+};
+
+enum QSpyCritKinds {
+    QSPY_CRIT_SECT, // QS_QF_CRIT_ENTRY/EXIT
+    QSPY_CRIT_INT,  // QS_QF_INT_DISABLE/ENABLE
+    QSPY_CRIT_KINDS
+};
+
+typedef struct {
+    uint8_t  rec;
+    bool     hasTstamp;
+    uint64_t ts;
+} QSpyCritCtx;
+
+typedef struct {
+    QSpyCritCtx before[QSPY_CRIT_CTX]; // the records before the entry
+    QSpyCritCtx inside[QSPY_CRIT_CTX]; // the first records inside
+    QSpyCritCtx after[QSPY_CRIT_CTX];  // the records after the exit
+    uint8_t     nBefore;
+    uint8_t     nInside;
+    uint8_t     nAfter;
+    uint64_t    entryTs;
+    uint64_t    dur;
+} QSpyCritSpan;
+
+typedef struct {
+    uint32_t n;      // sections preceded by the record
+    uint64_t sum;    // total duration of the sections [ticks]
+    uint64_t max;    // the longest section [ticks]
+} QSpyCritPrev;
+
+typedef struct {
+    uint8_t      nest;       // the current nesting (0: outside)
+    uint8_t      maxNest;    // the deepest nesting
+    uint8_t      prevRec;    // the record preceding the current section
+    uint32_t     nUnmatched; // exits without entries or lost exits
+    uint32_t     nOver;      // sections over the limit
+    QSpyHist     dur;        // durations of the outermost sections
+    QSpyCritSpan cur;        // the current section
+    QSpyCritSpan worst;      // the longest section
+    QSpyCritPrev prev[256];  // per the record preceding the section
+} QSpyCritKind;
+
+typedef struct {
+    QSpyCritKind kind[QSPY_CRIT_KINDS];
+    QSpyCritCtx  hist[QSPY_CRIT_CTX]; // the last records (ring buffer)
+    uint8_t      head;    // the next entry in hist[]
+    uint8_t      nHist;   // the number of the entries in hist[]
+    uint64_t     limit;   // the limit of the durations [ticks] (0: none)
+    bool         reportOnDone; // report at QS_TARGET_DONE (true by default)
+} QSpyCritSect;
+
+void QSpyCritSect_ctor(QSpyCritSect * const me, uint64_t limit);
+void QSpyCritSect_xtor(QSpyCritSect * const me);
+void QSpyCritSect_onRecord(QSpyCritSect * const me, QSpyRecData const *data);
+void QSpyCritSect_report(QSpyCritSect const * const me);
 
 // simplified string_copy() implementation "good enough" for the intended use
 int string_copy(char *dest, size_t dest_size, char const *src);
@@ -287,16 +1148,11 @@ typedef enum {
     QSPY_SEND_TEST_PROBE, // send Test-Probe (QSPY supplying apiId)
     QSPY_CLEAR_SCREEN,    // clear the QSPY screen
     QSPY_SHOW_NOTE,       // show a note in QSPY output
+    QSPY_FLIGHT_DUMP,     // dump the flight recorder in QSPY
+    QSPY_STATS,           // poll the decoder statistics of QSPY
     // ...
 } QSpyCommands;
 
-extern QSpyConfig    QSPY_conf;
-extern Dictionary    QSPY_funDict;
-extern Dictionary    QSPY_objDict;
-extern Dictionary    QSPY_usrDict;
-extern SigDictionary QSPY_sigDict;
-extern Dictionary    QSPY_enumDict[8];
-
 void QSPY_setExternDict(char const* dictName);
 QSpyStatus QSPY_readDict(void);
 QSpyStatus QSPY_writeDict(void);
@@ -0,0 +1,1642 @@
+//============================================================================
+// QSPY software tracing host-side utility
+//
+//                   Q u a n t u m  L e a P s
+//                   ------------------------
+//                   Modern Embedded Software
+//
+// Copyright(C) 2005 Quantum Leaps, LLC.All rights reserved.
+//
+// This software is licensed under the terms of the Quantum Leaps
+// QSPY SOFTWARE TRACING HOST UTILITY SOFTWARE END USER LICENSE.
+// Please see the file LICENSE-qspy.txt for the complete license text.
+//
+// Quantum Leaps contact information :
+// <www.state-machine.com/licensing>
+// <info@state-machine.com>
+//============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#define Q_SPY   1       // this is QS implementation
+#define QP_IMPL 1       // this is QP implementation
+typedef int      int_t;   // dummy definition for including "qpc_qs.h"
+typedef int      enum_t;  // dummy definition for including "qpc_qs.h"
+typedef uint16_t QSignal; // dummy definition for including "qpc_qs.h"
+typedef uint32_t QSFun;   // dummy definition for including "qpc_qs.h"
+typedef uint32_t QSObj;   // dummy definition for including "qpc_qs.h"
+typedef uint32_t QEvt;    // dummy definition for including "qpc_qs.h"
+typedef uint32_t QActive; // dummy definition for including "qpc_qs.h"
+typedef uint32_t QPSet;   // dummy definition for including "qpc_qs.h"
+#include "qpc_qs.h"       // QS target-resident interface
+#include "qpc_qs_pkg.h"   // QS package-scope interface
+
+#include "safe_std.h"   // "safe" <stdio.h> and <string.h> facilities
+#include "qspy.h"       // QSPY data parser
+#include "pal.h"        // Platform Abstraction Layer
+
+// the value of the field of the record being analyzed
+#define FLD_U(data_, i_)  ((data_)->fld[(i_)].val.u)
+
+//............................................................................
+// grow the array *pArr of *pMax elements to hold at least n elements
+static bool QANA_grow(void **pArr, uint32_t *pMax, uint32_t n,
+                      size_t elSize)
+{
+    if (n <= *pMax) {
+        return true;
+    }
+    uint32_t max = (*pMax > 0U) ? *pMax : 16U;
+    while (max < n) {
+        max *= 2U;
+    }
+    void *arr = realloc(*pArr, (size_t)max * elSize);
+    if (arr == (void *)0) {
+        return false;
+    }
+    memset((uint8_t *)arr + ((size_t)*pMax * elSize), 0,
+           (size_t)(max - *pMax) * elSize);
+    *pArr = arr;
+    *pMax = max;
+    return true;
+}
+//............................................................................
+// make room for one more element in the ring buffer *pRing of *pMax
+// elements (power of 2) with *pN elements from *pHead. The ring grows up
+// to 'limit' elements and then drops its oldest element. Returns false
+// if the new element must be dropped for the lack of memory. The dropped
+// elements are counted in *pDropped.
+static bool QANA_ringRoom(void **pRing, uint32_t *pHead, uint32_t *pN,
+                          uint32_t *pMax, uint32_t limit, size_t elSize,
+                          uint32_t *pDropped)
+{
+    if (*pN < *pMax) {
+        return true;
+    }
+    if (*pMax == limit) { // drop the oldest
+        *pHead = (*pHead + 1U) & (*pMax - 1U);
+        --(*pN);
+        ++(*pDropped);
+        return true;
+    }
+    // grow the ring buffer (and make it contiguous)
+    uint32_t const max = (*pMax > 0U) ? 2U*(*pMax) : 16U;
+    uint8_t *ring = (uint8_t *)malloc((size_t)max * elSize);
+    if (ring == (uint8_t *)0) {
+        ++(*pDropped);
+        return false;
+    }
+    uint32_t const n1 = *pMax - *pHead; // from the head to the end
+    uint8_t const * const old = (uint8_t const *)*pRing;
+    if (*pN > 0U) {
+        memcpy(ring, &old[(size_t)*pHead * elSize], (size_t)n1 * elSize);
+        memcpy(&ring[(size_t)n1 * elSize], old, (size_t)*pHead * elSize);
+    }
+    free(*pRing);
+    *pRing = ring;
+    *pMax  = max;
+    *pHead = 0U;
+    return true;
+}
+//............................................................................
+// sort the indexes of the used keys[0..n-1] in order[] by the decreasing
+// keys (the lower index first for the same key), returns the number of
+// the used keys
+static uint32_t QANA_order(uint64_t const *keys, bool const *used,
+                           uint32_t n, uint32_t *order)
+{
+    uint32_t nUsed = 0U;
+    for (uint32_t i = 0U; i < n; ++i) {
+        if (used[i]) { // insertion sort (stable)
+            uint32_t j = nUsed++;
+            while ((j > 0U) && (keys[order[j - 1U]] < keys[i])) {
+                order[j] = order[j - 1U];
+                --j;
+            }
+            order[j] = i;
+        }
+    }
+    return nUsed;
+}
+//............................................................................
+// export a sample {tstamp, object, nFree, nMin} to the given file
+static void QANA_export(void *expFile, bool csv, uint64_t ts,
+                        uint64_t obj, uint16_t nFree, uint16_t nMin)
+{
+    FILE * const f = (FILE *)expFile;
+    if (csv) {
+        FPRINTF_S(f, "%" PRIu64 ",%s,%u,%u\n",
+                  ts,
+                  Dictionary_get(&QSPY_objDict, obj, (char *)0),
+                  (unsigned)nFree,
+                  (unsigned)nMin);
+    }
+    else {
+        uint8_t buf[20];
+        for (uint8_t i = 0U; i < 8U; ++i) {
+            buf[i]      = (uint8_t)(ts >> (8U * i));
+            buf[8U + i] = (uint8_t)(obj >> (8U * i));
+        }
+        buf[16] = (uint8_t)nFree;
+        buf[17] = (uint8_t)(nFree >> 8U);
+        buf[18] = (uint8_t)nMin;
+        buf[19] = (uint8_t)(nMin >> 8U);
+        (void)fwrite(buf, 1U, sizeof(buf), f);
+    }
+}
+// the reports are printed even when the text rendering of the records is
+// disabled (SNPRINTF_LINE() formats only with the text rendering enabled)
+#define QANA_REPORT_BEGIN() \
+    bool const textOn_ = QSPY_TEXT_ON(); QSPY_currParser->textOn = true
+#define QANA_REPORT_END() \
+    QSPY_currParser->textOn = textOn_
+
+//============================================================================
+// HDR-style histogram...
+enum {
+    QSPY_HIST_HALF = 1U << (QSPY_HIST_BITS - 1), // buckets per power of 2
+};
+
+//............................................................................
+static uint32_t QSpyHist_msb(uint64_t v) { // v != 0
+#if defined(__GNUC__)
+    return 63U - (uint32_t)__builtin_clzll(v);
+#else
+    uint32_t m = 0U;
+    while ((v >>= 1U) != 0U) {
+        ++m;
+    }
+    return m;
+#endif
+}
+//............................................................................
+static uint32_t QSpyHist_index(uint64_t v) {
+    if (v < (2U * QSPY_HIST_HALF)) {
+        return (uint32_t)v;
+    }
+    uint32_t const s = QSpyHist_msb(v) - (QSPY_HIST_BITS - 1U);
+    return (s * QSPY_HIST_HALF) + (uint32_t)(v >> s);
+}
+//............................................................................
+// the highest value of the given bucket
+static uint64_t QSpyHist_upper(uint32_t idx) {
+    if (idx < (2U * QSPY_HIST_HALF)) {
+        return idx;
+    }
+    uint32_t const s   = (idx / QSPY_HIST_HALF) - 1U;
+    uint64_t const top = idx - (s * QSPY_HIST_HALF);
+    return ((top + 1U) << s) - 1U;
+}
+//............................................................................
+void QSpyHist_ctor(QSpyHist * const me) {
+    me->counts  = (uint32_t *)0;
+    me->nCounts = 0U;
+    me->total   = 0U;
+    me->min     = UINT64_MAX;
+    me->max     = 0U;
+}
+//............................................................................
+void QSpyHist_xtor(QSpyHist * const me) {
+    free(me->counts);
+    QSpyHist_ctor(me);
+}
+//............................................................................
+void QSpyHist_record(QSpyHist * const me, uint64_t val) {
+    uint32_t const idx = QSpyHist_index(val);
+    if ((idx >= me->nCounts)
+        && !QANA_grow((void **)&me->counts, &me->nCounts, idx + 1U,
+                      sizeof(me->counts[0])))
+    {
+        return; // value lost
+    }
+    ++me->counts[idx];
+    ++me->total;
+    if (val < me->min) {
+        me->min = val;
+    }
+    if (val > me->max) {
+        me->max = val;
+    }
+}
+//............................................................................
+uint64_t QSpyHist_percentile(QSpyHist const * const me, double pct) {
+    if (me->total == 0U) {
+        return 0U;
+    }
+    uint64_t rank = (uint64_t)((pct / 100.0) * (double)me->total + 0.5);
+    if (rank < 1U) {
+        rank = 1U;
+    }
+    uint64_t cum = 0U;
+    for (uint32_t i = 0U; i < me->nCounts; ++i) {
+        cum += me->counts[i];
+        if (cum >= rank) {
+            uint64_t const v = QSpyHist_upper(i);
+            return (v < me->min) ? me->min
+                   : ((v > me->max) ? me->max : v);
+        }
+    }
+    return me->max;
+}
+
+//============================================================================
+// map of 64-bit keys...
+
+//............................................................................
+static uint32_t QSpyMap_hash(QSpyMap const * const me, uint64_t key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32U) & me->mask;
+}
+//............................................................................
+void QSpyMap_ctor(QSpyMap * const me) {
+    me->keys = (uint64_t *)0;
+    me->vals = (uint32_t *)0;
+    me->mask = 0U;
+    me->n    = 0U;
+}
+//............................................................................
+void QSpyMap_xtor(QSpyMap * const me) {
+    free(me->keys);
+    free(me->vals);
+    QSpyMap_ctor(me);
+}
+//............................................................................
+uint32_t QSpyMap_get(QSpyMap const * const me, uint64_t key) {
+    if (me->vals == (uint32_t *)0) {
+        return QSPY_MAP_NONE;
+    }
+    for (uint32_t i = QSpyMap_hash(me, key); ; i = (i + 1U) & me->mask) {
+        if (me->vals[i] == QSPY_MAP_NONE) {
+            return QSPY_MAP_NONE;
+        }
+        if (me->keys[i] == key) {
+            return me->vals[i];
+        }
+    }
+}
+//............................................................................
+bool QSpyMap_put(QSpyMap * const me, uint64_t key, uint32_t val) {
+    Q_ASSERT(val != QSPY_MAP_NONE);
+
+    if ((me->n + 1U) * 4U > (me->mask + 1U) * 3U) { // grow over 3/4?
+        uint32_t const size = (me->vals != (uint32_t *)0)
+                              ? 2U * (me->mask + 1U) : 64U;
+        QSpyMap old = *me;
+        me->keys = (uint64_t *)malloc(size * sizeof(uint64_t));
+        me->vals = (uint32_t *)malloc(size * sizeof(uint32_t));
+        if ((me->keys == (uint64_t *)0) || (me->vals == (uint32_t *)0)) {
+            free(me->keys);
+            free(me->vals);
+            *me = old;
+            return false;
+        }
+        memset(me->vals, 0xFF, size * sizeof(uint32_t)); // QSPY_MAP_NONE
+        me->mask = size - 1U;
+        me->n    = 0U;
+        if (old.vals != (uint32_t *)0) {
+            for (uint32_t i = 0U; i <= old.mask; ++i) {
+                if (old.vals[i] != QSPY_MAP_NONE) {
+                    (void)QSpyMap_put(me, old.keys[i], old.vals[i]);
+                }
+            }
+        }
+        QSpyMap_xtor(&old);
+    }
+    uint32_t i = QSpyMap_hash(me, key);
+    while ((me->vals[i] != QSPY_MAP_NONE) && (me->keys[i] != key)) {
+        i = (i + 1U) & me->mask;
+    }
+    if (me->vals[i] == QSPY_MAP_NONE) {
+        ++me->n;
+    }
+    me->keys[i] = key;
+    me->vals[i] = val;
+    return true;
+}
+//............................................................................
+// NOTE: the following entries of the probe sequence are shifted back
+// into the freed slot, so that no "tombstones" are needed
+void QSpyMap_remove(QSpyMap * const me, uint64_t key) {
+    if (me->vals == (uint32_t *)0) {
+        return;
+    }
+    uint32_t i = QSpyMap_hash(me, key);
+    for (;;) {
+        if (me->vals[i] == QSPY_MAP_NONE) {
+            return; // not found
+        }
+        if (me->keys[i] == key) {
+            break;
+        }
+        i = (i + 1U) & me->mask;
+    }
+    for (uint32_t j = i; ; ) {
+        j = (j + 1U) & me->mask;
+        if (me->vals[j] == QSPY_MAP_NONE) {
+            break;
+        }
+        uint32_t const h = QSpyMap_hash(me, me->keys[j]);
+        bool const stays = (i <= j) ? ((i < h) && (h <= j))
+                                    : ((i < h) || (h <= j));
+        if (!stays) { // move the entry j into the hole i
+            me->keys[i] = me->keys[j];
+            me->vals[i] = me->vals[j];
+            i = j;
+        }
+    }
+    me->vals[i] = QSPY_MAP_NONE;
+    --me->n;
+}
+
+//............................................................................
+// the index of the element for the key in the array *pArr (mapped by idx),
+// with a new zeroed element appended for a new key (*pIsNew set), or
+// QSPY_MAP_NONE for the lack of memory
+static uint32_t QANA_lookup(QSpyMap * const idx, uint64_t key,
+                            void **pArr, uint32_t *pN, uint32_t *pMax,
+                            size_t elSize, bool *pIsNew)
+{
+    uint32_t i = QSpyMap_get(idx, key);
+    *pIsNew = (i == QSPY_MAP_NONE);
+    if (*pIsNew) {
+        if (!QANA_grow(pArr, pMax, *pN + 1U, elSize)
+            || !QSpyMap_put(idx, key, *pN))
+        {
+            return QSPY_MAP_NONE;
+        }
+        i = (*pN)++;
+    }
+    return i;
+}
+
+//============================================================================
+// event latency analyzer...
+
+//............................................................................
+void QSpyLatency_ctor(QSpyLatency * const me) {
+    memset(me, 0, sizeof(*me));
+    QSpyMap_ctor(&me->aoIdx);
+    me->reportOnDone = true;
+}
+//............................................................................
+void QSpyLatency_xtor(QSpyLatency * const me) {
+    for (uint32_t i = 0U; i < me->nAos; ++i) {
+        free(me->aos[i].posts);
+        QSpyMap_xtor(&me->aos[i].sigHist);
+    }
+    for (uint32_t i = 0U; i < me->nHist; ++i) {
+        QSpyHist_xtor(&me->hist[i].post2disp);
+        QSpyHist_xtor(&me->hist[i].disp2done);
+    }
+    QSpyMap_xtor(&me->aoIdx);
+    free(me->aos);
+    free(me->hist);
+    QSpyLatency_ctor(me);
+}
+//............................................................................
+static QSpyLatAO *QSpyLatency_ao(QSpyLatency * const me, uint64_t ao) {
+    bool isNew;
+    uint32_t const idx = QANA_lookup(&me->aoIdx, ao, (void **)&me->aos,
+                                     &me->nAos, &me->maxAos,
+                                     sizeof(QSpyLatAO), &isNew);
+    if (idx == QSPY_MAP_NONE) {
+        return (QSpyLatAO *)0;
+    }
+    QSpyLatAO * const a = &me->aos[idx];
+    if (isNew) {
+        a->ao = ao;
+        QSpyMap_ctor(&a->sigHist);
+    }
+    return a;
+}
+//............................................................................
+// returns the hist[] index for the (AO, signal) or QSPY_MAP_NONE
+static uint32_t QSpyLatency_hist(QSpyLatency * const me,
+                                 QSpyLatAO * const a, uint32_t sig)
+{
+    bool isNew;
+    uint32_t const idx = QANA_lookup(&a->sigHist, sig, (void **)&me->hist,
+                                     &me->nHist, &me->maxHist,
+                                     sizeof(QSpyLatHist), &isNew);
+    if ((idx != QSPY_MAP_NONE) && isNew) {
+        QSpyLatHist * const h = &me->hist[idx];
+        h->ao  = a->ao;
+        h->sig = sig;
+        QSpyHist_ctor(&h->post2disp);
+        QSpyHist_ctor(&h->disp2done);
+    }
+    return idx;
+}
+//............................................................................
+static void QSpyLatency_post(QSpyLatency * const me, QSpyLatAO * const a,
+                             uint64_t ts, uint32_t sig, bool lifo)
+{
+    // when the gets are not traced, the oldest posts are dropped
+    if (!QANA_ringRoom((void **)&a->posts, &a->head, &a->nPosts,
+                       &a->maxPosts, QSPY_LAT_POSTS_MAX,
+                       sizeof(QSpyLatPost), &me->nDropped))
+    {
+        return;
+    }
+    uint32_t const mask = a->maxPosts - 1U;
+    uint32_t i;
+    if (lifo) {
+        a->head = (a->head - 1U) & mask;
+        i = a->head;
+    }
+    else {
+        i = (a->head + a->nPosts) & mask;
+    }
+    a->posts[i].ts  = ts;
+    a->posts[i].sig = sig;
+    ++a->nPosts;
+}
+//............................................................................
+// the RTC step of the AO in progress (if any) completed at ts
+static void QSpyLatency_done(QSpyLatency * const me, QSpyLatAO * const a,
+                             uint64_t ts)
+{
+    if (a->busy != 0U) {
+        if (a->isPaused) { // completed without the restore traced
+            a->paused += ts - a->pauseTs;
+            a->isPaused = false;
+        }
+        QSpyHist_record(&me->hist[a->busy - 1U].disp2done,
+                        ts - a->dispTs - a->paused);
+        a->busy = 0U;
+        --me->nBusy;
+    }
+}
+//............................................................................
+// the RTC step running at the current preemption level (or NULL)
+static QSpyLatAO *QSpyLatency_running(QSpyLatency const * const me) {
+    if ((me->level < QSPY_LAT_LEVELS) && (me->run[me->level] != 0U)) {
+        QSpyLatAO * const a = &me->aos[me->run[me->level] - 1U];
+        if (a->busy != 0U) {
+            return a;
+        }
+    }
+    return (QSpyLatAO *)0;
+}
+//............................................................................
+// the RTC step at the current preemption level (if any) completed at ts
+static void QSpyLatency_doneLevel(QSpyLatency * const me, uint64_t ts) {
+    QSpyLatAO * const a = QSpyLatency_running(me);
+    if (a != (QSpyLatAO *)0) {
+        QSpyLatency_done(me, a, ts);
+    }
+    if (me->level < QSPY_LAT_LEVELS) {
+        me->run[me->level] = 0U;
+    }
+}
+//............................................................................
+static void QSpyLatency_preempt(QSpyLatency * const me, uint64_t ts) {
+    QSpyLatAO * const a = QSpyLatency_running(me);
+    if ((a != (QSpyLatAO *)0) && !a->isPaused) {
+        a->pauseTs  = ts;
+        a->isPaused = true;
+    }
+    ++me->level;
+    if (me->level < QSPY_LAT_LEVELS) {
+        me->run[me->level] = 0U;
+    }
+}
+//............................................................................
+static void QSpyLatency_restore(QSpyLatency * const me, uint64_t ts) {
+    if (me->level == 0U) {
+        return; // the preemption not traced
+    }
+    QSpyLatency_doneLevel(me, ts); // the preempting step completed
+    --me->level;
+    QSpyLatAO * const a = QSpyLatency_running(me);
+    if ((a != (QSpyLatAO *)0) && a->isPaused) {
+        a->paused  += ts - a->pauseTs;
+        a->isPaused = false;
+    }
+}
+//............................................................................
+static void QSpyLatency_get(QSpyLatency * const me, QSpyLatAO * const a,
+                            uint64_t ts, uint32_t sig)
+{
+    // the AO moves on to the next event: complete its RTC step
+    QSpyLatency_done(me, a, ts);
+
+    // find the post of the signal (dropping the posts before it, whose
+    // gets were lost)
+    uint32_t const mask = a->maxPosts - 1U;
+    uint32_t k = 0U;
+    while ((k < a->nPosts) && (a->posts[(a->head + k) & mask].sig != sig)) {
+        ++k;
+    }
+    if (k < a->nPosts) {
+        a->postTs  = a->posts[(a->head + k) & mask].ts;
+        a->hasPost = true;
+        a->head    = (a->head + k + 1U) & mask;
+        a->nPosts -= k + 1U;
+        me->nDropped += k;
+    }
+    else {
+        a->hasPost = false;
+        ++me->nUnmatched;
+    }
+    a->getSig = sig;
+    a->hasGet = true;
+}
+//............................................................................
+static void QSpyLatency_dispatch(QSpyLatency * const me,
+                                 QSpyLatAO * const a,
+                                 uint64_t ts, uint32_t sig)
+{
+    if (!a->hasGet || (a->getSig != sig)) {
+        return; // not an event got from the AO's queue
+    }
+    a->hasGet = false;
+    uint32_t const idx = QSpyLatency_hist(me, a, sig);
+    if (idx == QSPY_MAP_NONE) {
+        return;
+    }
+    if (a->hasPost) {
+        QSpyHist_record(&me->hist[idx].post2disp, ts - a->postTs);
+    }
+    QSpyLatency_doneLevel(me, ts); // the previous step of the level
+    QSpyLatency_done(me, a, ts);
+    a->busy     = idx + 1U;
+    a->dispTs   = ts;
+    a->paused   = 0U;
+    a->isPaused = false;
+    ++me->nBusy;
+    if (me->level < QSPY_LAT_LEVELS) {
+        me->run[me->level] = (uint32_t)(a - me->aos) + 1U;
+    }
+}
+//............................................................................
+void QSpyLatency_onRecord(QSpyLatency * const me, QSpyRecData const *data) {
+    if ((data->rec == QS_TARGET_DONE) && me->reportOnDone) {
+        QSpyLatency_report(me);
+    }
+    if (!data->hasTstamp) {
+        return;
+    }
+    uint64_t const ts = data->tstamp64;
+    QSpyLatAO *a;
+    switch (data->rec) {
+        case QS_QF_ACTIVE_POST: // TS, sender, sig, AO, ...
+            if ((data->nFld >= 4U)
+                && ((a = QSpyLatency_ao(me, FLD_U(data, 3))) != (QSpyLatAO *)0))
+            {
+                QSpyLatency_post(me, a, ts, (uint32_t)FLD_U(data, 2), false);
+            }
+            break;
+        case QS_QF_ACTIVE_POST_LIFO: // TS, sig, AO, ...
+            if ((data->nFld >= 3U)
+                && ((a = QSpyLatency_ao(me, FLD_U(data, 2))) != (QSpyLatAO *)0))
+            {
+                QSpyLatency_post(me, a, ts, (uint32_t)FLD_U(data, 1), true);
+            }
+            break;
+        case QS_QF_ACTIVE_GET:
+        case QS_QF_ACTIVE_GET_LAST: // TS, sig, AO, ...
+            if ((data->nFld >= 3U)
+                && ((a = QSpyLatency_ao(me, FLD_U(data, 2))) != (QSpyLatAO *)0))
+            {
+                QSpyLatency_get(me, a, ts, (uint32_t)FLD_U(data, 1));
+            }
+            break;
+        case QS_QEP_DISPATCH: // TS, sig, obj, state
+            if (data->nFld >= 3U) {
+                uint32_t const idx = QSpyMap_get(&me->aoIdx, FLD_U(data, 2));
+                if (idx != QSPY_MAP_NONE) {
+                    QSpyLatency_dispatch(me, &me->aos[idx], ts,
+                                         (uint32_t)FLD_U(data, 1));
+                }
+            }
+            break;
+        case QS_SCHED_NEXT:
+            QSpyLatency_doneLevel(me, ts);
+            break;
+        case QS_SCHED_IDLE: // no RTC step can be in progress
+            for (uint32_t i = 0U; (i < me->nAos) && (me->nBusy > 0U); ++i) {
+                QSpyLatency_done(me, &me->aos[i], ts);
+            }
+            me->level  = 0U;
+            me->run[0] = 0U;
+            break;
+        case QS_SCHED_PREEMPT:
+            QSpyLatency_preempt(me, ts);
+            break;
+        case QS_SCHED_RESTORE:
+            QSpyLatency_restore(me, ts);
+            break;
+        default:
+            break;
+    }
+}
+//............................................................................
+void QSpyLatency_report(QSpyLatency const * const me) {
+    QANA_REPORT_BEGIN();
+    char aoName[QS_DNAME_LEN_MAX];
+    char sigName[QS_DNAME_LEN_MAX];
+
+    SNPRINTF_LINE("           Latency  [ticks] AOs=%u,Unmatched=%u,"
+                  "Dropped=%u",
+                  (unsigned)me->nAos,
+                  (unsigned)me->nUnmatched,
+                  (unsigned)me->nDropped);
+    QSPY_printInfo();
+    for (uint32_t i = 0U; i < me->nHist; ++i) {
+        QSpyLatHist const * const h = &me->hist[i];
+        SNPRINTF_LINE("           Latency  Obj=%s,Sig=%s,"
+                      "Post->Disp(n=%" PRIu64 ",p50=%" PRIu64
+                      ",p99=%" PRIu64 ",max=%" PRIu64 "),"
+                      "Disp->Done(n=%" PRIu64 ",p50=%" PRIu64
+                      ",p99=%" PRIu64 ",max=%" PRIu64 ")",
+                      Dictionary_get(&QSPY_objDict, h->ao, aoName),
+                      SigDictionary_get(&QSPY_sigDict, h->sig, h->ao,
+                                        sigName),
+                      h->post2disp.total,
+                      QSpyHist_percentile(&h->post2disp, 50.0),
+                      QSpyHist_percentile(&h->post2disp, 99.0),
+                      h->post2disp.max,
+                      h->disp2done.total,
+                      QSpyHist_percentile(&h->disp2done, 50.0),
+                      QSpyHist_percentile(&h->disp2done, 99.0),
+                      h->disp2done.max);
+        QSPY_printInfo();
+    }
+    QANA_REPORT_END();
+}
+
+//============================================================================
+// queue occupancy tracker...
+
+//............................................................................
+void QSpyQueues_ctor(QSpyQueues * const me, uint16_t lowFree) {
+    memset(me, 0, sizeof(*me));
+    QSpyMap_ctor(&me->idx);
+    me->lowFree = lowFree;
+}
+//............................................................................
+void QSpyQueues_xtor(QSpyQueues * const me) {
+    QSpyMap_xtor(&me->idx);
+    free(me->queues);
+    QSpyQueues_ctor(me, me->lowFree);
+}
+//............................................................................
+void QSpyQueues_configExport(QSpyQueues * const me,
+                             void *expFile, bool csv)
+{
+    me->expFile = expFile;
+    me->csv     = csv;
+    if ((expFile != (void *)0) && csv) {
+        FPRINTF_S((FILE *)expFile, "%s\n", "tstamp,queue,nFree,nMin");
+    }
+}
+//............................................................................
+static QSpyQueue *QSpyQueues_queue(QSpyQueues * const me,
+                                   uint64_t obj, bool isAO)
+{
+    bool isNew;
+    uint32_t const idx = QANA_lookup(&me->idx, obj, (void **)&me->queues,
+                                     &me->nQueues, &me->maxQueues,
+                                     sizeof(QSpyQueue), &isNew);
+    if (idx == QSPY_MAP_NONE) {
+        return (QSpyQueue *)0;
+    }
+    QSpyQueue * const q = &me->queues[idx];
+    if (isNew) {
+        q->obj      = obj;
+        q->isAO     = isAO;
+        q->nMin     = 0xFFFFU;
+        q->alertMin = 0xFFFFU;
+    }
+    return q;
+}
+//............................................................................
+static void QSpyQueues_sample(QSpyQueues * const me, QSpyQueue * const q,
+                              uint64_t ts, uint16_t nFree)
+{
+    if (q->valid) { // account for the time since the last sample
+        uint64_t const dt = ts - q->lastTs;
+        q->freeTime += (uint64_t)q->nFree * dt;
+        if (q->nFree <= me->lowFree) {
+            q->lowTime += dt;
+        }
+    }
+    else {
+        q->valid   = true;
+        q->firstTs = ts;
+    }
+    q->nFree  = nFree;
+    q->lastTs = ts;
+    if (nFree > q->maxFree) {
+        q->maxFree = nFree;
+    }
+
+    if (me->expFile != (void *)0) {
+        QANA_export(me->expFile, me->csv, ts, q->obj, nFree, q->nMin);
+    }
+}
+//............................................................................
+static void QSpyQueues_min(QSpyQueues * const me, QSpyQueue * const q,
+                           uint16_t nMin, uint16_t nFree)
+{
+    if (nFree > q->maxFree) {
+        q->maxFree = nFree;
+    }
+    if (nMin < q->nMin) {
+        q->nMin = nMin;
+    }
+    if ((nMin <= me->lowFree) && (nMin < q->alertMin)) { // a new low?
+        q->alertMin = nMin;
+        QANA_REPORT_BEGIN();
+        SNPRINTF_LINE("           Queue    ALERT Obj=%s,nMin=%u,"
+                      "Capacity>=%u",
+                      Dictionary_get(&QSPY_objDict, q->obj, (char *)0),
+                      (unsigned)nMin,
+                      (unsigned)q->maxFree);
+        QSPY_printError();
+        QANA_REPORT_END();
+    }
+}
+//............................................................................
+void QSpyQueues_onRecord(QSpyQueues * const me, QSpyRecData const *data) {
+    if (!data->hasTstamp) {
+        return;
+    }
+    uint64_t const ts = data->tstamp64;
+    QSpyQueue *q;
+    switch (data->rec) {
+        case QS_QF_ACTIVE_POST: // TS, sender, sig, AO, pool, ref, nFree, nMin
+            if ((data->nFld >= 8U)
+                && ((q = QSpyQueues_queue(me, FLD_U(data, 3), true))
+                    != (QSpyQueue *)0))
+            {
+                ++q->nPosts;
+                QSpyQueues_min(me, q, (uint16_t)FLD_U(data, 7),
+                               (uint16_t)FLD_U(data, 6));
+                QSpyQueues_sample(me, q, ts, (uint16_t)FLD_U(data, 6));
+            }
+            break;
+        case QS_QF_ACTIVE_POST_LIFO:
+        case QS_QF_EQUEUE_POST:
+        case QS_QF_EQUEUE_POST_LIFO: // TS, sig, queue, pool, ref, nFree, nMin
+            if ((data->nFld >= 7U)
+                && ((q = QSpyQueues_queue(me, FLD_U(data, 2),
+                             data->rec == QS_QF_ACTIVE_POST_LIFO))
+                    != (QSpyQueue *)0))
+            {
+                ++q->nPosts;
+                QSpyQueues_min(me, q, (uint16_t)FLD_U(data, 6),
+                               (uint16_t)FLD_U(data, 5));
+                QSpyQueues_sample(me, q, ts, (uint16_t)FLD_U(data, 5));
+            }
+            break;
+        case QS_QF_ACTIVE_GET:
+        case QS_QF_EQUEUE_GET: // TS, sig, queue, pool, ref, nFree
+            if ((data->nFld >= 6U)
+                && ((q = QSpyQueues_queue(me, FLD_U(data, 2),
+                             data->rec == QS_QF_ACTIVE_GET))
+                    != (QSpyQueue *)0))
+            {
+                ++q->nGets;
+                QSpyQueues_sample(me, q, ts, (uint16_t)FLD_U(data, 5));
+            }
+            break;
+        case QS_QF_ACTIVE_GET_LAST:
+        case QS_QF_EQUEUE_GET_LAST: // TS, sig, queue, pool, ref
+            if ((data->nFld >= 3U)
+                && ((q = QSpyQueues_queue(me, FLD_U(data, 2),
+                             data->rec == QS_QF_ACTIVE_GET_LAST))
+                    != (QSpyQueue *)0))
+            {
+                ++q->nGets;
+                QSpyQueues_sample(me, q, ts, q->maxFree); // empty now
+            }
+            break;
+        default:
+            break;
+    }
+}
+//............................................................................
+void QSpyQueues_report(QSpyQueues const * const me) {
+    QANA_REPORT_BEGIN();
+    for (uint32_t i = 0U; i < me->nQueues; ++i) {
+        QSpyQueue const * const q = &me->queues[i];
+        uint64_t const span = q->lastTs - q->firstTs;
+        SNPRINTF_LINE("           Queue    Obj=%s,%s,Posts=%u,Gets=%u,"
+                      "Free=%u,Min=%u,Capacity>=%u,AvgFree=%.1f,"
+                      "TimeLow=%" PRIu64 "(%.1f%%)",
+                      Dictionary_get(&QSPY_objDict, q->obj, (char *)0),
+                      q->isAO ? "AO" : "EQ",
+                      (unsigned)q->nPosts,
+                      (unsigned)q->nGets,
+                      (unsigned)q->nFree,
+                      (unsigned)((q->nMin != 0xFFFFU) ? q->nMin : q->maxFree),
+                      (unsigned)q->maxFree,
+                      (span > 0U) ? ((double)q->freeTime / (double)span)
+                                  : (double)q->nFree,
+                      q->lowTime,
+                      (span > 0U) ? (100.0 * (double)q->lowTime
+                                     / (double)span)
+                                  : 0.0);
+        QSPY_printInfo();
+    }
+    QANA_REPORT_END();
+}
+
+//============================================================================
+// memory pool tracker...
+
+//............................................................................
+void QSpyPools_ctor(QSpyPools * const me) {
+    memset(me, 0, sizeof(*me));
+    QSpyMap_ctor(&me->idx);
+}
+//............................................................................
+void QSpyPools_xtor(QSpyPools * const me) {
+    for (uint32_t i = 0U; i < me->nPools; ++i) {
+        QSpyHist_xtor(&me->pools[i].evtSize);
+    }
+    QSpyMap_xtor(&me->idx);
+    free(me->pools);
+    QSpyPools_ctor(me);
+}
+//............................................................................
+void QSpyPools_configExport(QSpyPools * const me, void *expFile, bool csv) {
+    me->expFile = expFile;
+    me->csv     = csv;
+    if ((expFile != (void *)0) && csv) {
+        FPRINTF_S((FILE *)expFile, "%s\n", "tstamp,pool,nFree,nMin");
+    }
+}
+//............................................................................
+static uint32_t QSpyPools_pool(QSpyPools * const me, uint64_t obj) {
+    bool isNew;
+    uint32_t const idx = QANA_lookup(&me->idx, obj, (void **)&me->pools,
+                                     &me->nPools, &me->maxPools,
+                                     sizeof(QSpyPool), &isNew);
+    if ((idx != QSPY_MAP_NONE) && isNew) {
+        QSpyPool * const pl = &me->pools[idx];
+        pl->obj  = obj;
+        pl->nMin = 0xFFFFU;
+        QSpyHist_ctor(&pl->evtSize);
+    }
+    return idx;
+}
+//............................................................................
+static void QSpyPools_sample(QSpyPools * const me, QSpyPool * const pl,
+                             uint64_t ts, uint16_t nFree)
+{
+    if (pl->valid) { // account for the time since the last sample
+        pl->freeTime += (uint64_t)pl->nFree * (ts - pl->lastTs);
+    }
+    else {
+        pl->valid   = true;
+        pl->firstTs = ts;
+    }
+    pl->nFree  = nFree;
+    pl->lastTs = ts;
+    if (nFree > pl->maxFree) {
+        pl->maxFree = nFree;
+    }
+    if (me->expFile != (void *)0) {
+        QANA_export(me->expFile, me->csv, ts, pl->obj, nFree, pl->nMin);
+    }
+}
+//............................................................................
+void QSpyPools_onRecord(QSpyPools * const me, QSpyRecData const *data) {
+    if (!data->hasTstamp) {
+        return;
+    }
+    uint64_t const ts = data->tstamp64;
+    uint32_t const lastGet = me->lastGet;
+    me->lastGet = 0U; // QS_QF_NEW must immediately follow the get
+    uint32_t idx;
+    switch (data->rec) {
+        case QS_QF_MPOOL_GET: // TS, pool, nFree, nMin
+            if ((data->nFld >= 4U)
+                && ((idx = QSpyPools_pool(me, FLD_U(data, 1)))
+                    != QSPY_MAP_NONE))
+            {
+                QSpyPool * const pl = &me->pools[idx];
+                ++pl->nGets;
+                if ((uint16_t)FLD_U(data, 3) < pl->nMin) {
+                    pl->nMin = (uint16_t)FLD_U(data, 3);
+                }
+                QSpyPools_sample(me, pl, ts, (uint16_t)FLD_U(data, 2));
+                me->lastGet = idx + 1U;
+            }
+            break;
+        case QS_QF_MPOOL_GET_ATTEMPT: // TS, pool, nFree, margin
+            if ((data->nFld >= 3U)
+                && ((idx = QSpyPools_pool(me, FLD_U(data, 1)))
+                    != QSPY_MAP_NONE))
+            {
+                QSpyPool * const pl = &me->pools[idx];
+                ++pl->nFails;
+                QSpyPools_sample(me, pl, ts, (uint16_t)FLD_U(data, 2));
+                me->lastGet = idx + 1U;
+            }
+            break;
+        case QS_QF_MPOOL_PUT: // TS, pool, nFree
+            if ((data->nFld >= 3U)
+                && ((idx = QSpyPools_pool(me, FLD_U(data, 1)))
+                    != QSPY_MAP_NONE))
+            {
+                QSpyPool * const pl = &me->pools[idx];
+                ++pl->nPuts;
+                QSpyPools_sample(me, pl, ts, (uint16_t)FLD_U(data, 2));
+            }
+            break;
+        case QS_QF_NEW:
+        case QS_QF_NEW_ATTEMPT: // TS, evtSize, sig
+            if ((data->nFld >= 2U) && (lastGet != 0U)) {
+                QSpyHist_record(&me->pools[lastGet - 1U].evtSize,
+                                FLD_U(data, 1));
+            }
+            break;
+        default:
+            break;
+    }
+}
+//............................................................................
+void QSpyPools_report(QSpyPools const * const me) {
+    QANA_REPORT_BEGIN();
+    for (uint32_t i = 0U; i < me->nPools; ++i) {
+        QSpyPool const * const pl = &me->pools[i];
+        uint64_t const span = pl->lastTs - pl->firstTs;
+        double const avgFree = (span > 0U)
+                               ? ((double)pl->freeTime / (double)span)
+                               : (double)pl->nFree;
+        uint32_t const nReq = pl->nGets + pl->nFails;
+        SNPRINTF_LINE("           MPool    Obj=%s,Gets=%u,Puts=%u,"
+                      "Fails=%u(%.2f%%),Free=%u,Min=%u,Capacity>=%u,"
+                      "AvgUsed=%.2f,EvtSize(n=%" PRIu64 ",p50=%" PRIu64
+                      ",max=%" PRIu64 ")",
+                      Dictionary_get(&QSPY_objDict, pl->obj, (char *)0),
+                      (unsigned)pl->nGets,
+                      (unsigned)pl->nPuts,
+                      (unsigned)pl->nFails,
+                      (nReq > 0U) ? (100.0 * pl->nFails / nReq) : 0.0,
+                      (unsigned)pl->nFree,
+                      (unsigned)((pl->nMin != 0xFFFFU)
+                                 ? pl->nMin : pl->nFree),
+                      (unsigned)pl->maxFree,
+                      (double)pl->maxFree - avgFree,
+                      pl->evtSize.total,
+                      QSpyHist_percentile(&pl->evtSize, 50.0),
+                      pl->evtSize.max);
+        QSPY_printInfo();
+    }
+    QANA_REPORT_END();
+}
+//............................................................................
+uint32_t QSpyPools_pack(QSpyPools const * const me,
+                        uint8_t *buf, uint32_t size)
+{
+    uint32_t const len = 2U + me->nPools*(8U + 3U*2U + 2U*4U + 2U);
+    if ((me->nPools > 0xFFFFU) || (len > size)) { // no room?
+        return 0U;
+    }
+    uint8_t *pos = buf;
+    *pos++ = (uint8_t)me->nPools;
+    *pos++ = (uint8_t)(me->nPools >> 8U);
+    for (uint32_t i = 0U; i < me->nPools; ++i) {
+        QSpyPool const * const pl = &me->pools[i];
+        uint64_t const fld[7] = {
+            pl->obj, pl->maxFree, pl->nFree,
+            (pl->nMin != 0xFFFFU) ? pl->nMin : pl->nFree,
+            pl->nGets, pl->nFails, pl->evtSize.max
+        };
+        static uint8_t const fldSize[7] = { 8U, 2U, 2U, 2U, 4U, 4U, 2U };
+        for (uint32_t k = 0U; k < 7U; ++k) {
+            for (uint8_t j = 0U; j < fldSize[k]; ++j) {
+                *pos++ = (uint8_t)(fld[k] >> (8U * j));
+            }
+        }
+    }
+    return (uint32_t)(pos - buf);
+}
+
+//============================================================================
+// event lifetime tracker...
+
+//............................................................................
+void QSpyEvtLife_ctor(QSpyEvtLife * const me, uint64_t leakAge) {
+    memset(me, 0, sizeof(*me));
+    QSpyMap_ctor(&me->idx);
+    me->leakAge = leakAge;
+}
+//............................................................................
+void QSpyEvtLife_xtor(QSpyEvtLife * const me) {
+    for (uint32_t i = 0U; i < me->nSigs; ++i) {
+        free(me->sigs[i].allocTs);
+        QSpyHist_xtor(&me->sigs[i].lifetime);
+    }
+    QSpyMap_xtor(&me->idx);
+    free(me->sigs);
+    QSpyEvtLife_ctor(me, me->leakAge);
+}
+//............................................................................
+static QSpyEvtSig *QSpyEvtLife_sig(QSpyEvtLife * const me, uint32_t sig) {
+    bool isNew;
+    uint32_t const idx = QANA_lookup(&me->idx, sig, (void **)&me->sigs,
+                                     &me->nSigs, &me->maxSigs,
+                                     sizeof(QSpyEvtSig), &isNew);
+    if (idx == QSPY_MAP_NONE) {
+        return (QSpyEvtSig *)0;
+    }
+    QSpyEvtSig * const e = &me->sigs[idx];
+    if (isNew) {
+        e->sig = sig;
+        QSpyHist_ctor(&e->lifetime);
+    }
+    return e;
+}
+//............................................................................
+static void QSpyEvtLife_new(QSpyEvtLife * const me, QSpyEvtSig * const e,
+                            uint64_t ts)
+{
+    ++e->nNew;
+    if (!QANA_ringRoom((void **)&e->allocTs, &e->head, &e->nLive,
+                       &e->maxLive, QSPY_EVT_LIVE_MAX,
+                       sizeof(uint64_t), &me->nDropped))
+    {
+        return;
+    }
+    e->allocTs[(e->head + e->nLive) & (e->maxLive - 1U)] = ts;
+    ++e->nLive;
+    if (e->nLive > e->peakLive) {
+        e->peakLive = e->nLive;
+    }
+}
+//............................................................................
+static void QSpyEvtLife_gc(QSpyEvtLife * const me, QSpyEvtSig * const e,
+                           uint64_t ts)
+{
+    ++e->nGc;
+    if (e->nLive == 0U) { // allocated before the capture or an anomaly
+        ++me->nUnmatched;
+        return;
+    }
+    QSpyHist_record(&e->lifetime, ts - e->allocTs[e->head]);
+    e->head = (e->head + 1U) & (e->maxLive - 1U);
+    --e->nLive;
+}
+//............................................................................
+void QSpyEvtLife_onRecord(QSpyEvtLife * const me, QSpyRecData const *data) {
+    if (!data->hasTstamp) {
+        return;
+    }
+    uint64_t const ts = data->tstamp64;
+    me->lastTs = ts;
+    QSpyEvtSig *e;
+    switch (data->rec) {
+        case QS_QF_NEW: // TS, evtSize, sig
+            if ((data->nFld >= 3U)
+                && ((e = QSpyEvtLife_sig(me, (uint32_t)FLD_U(data, 2)))
+                    != (QSpyEvtSig *)0))
+            {
+                QSpyEvtLife_new(me, e, ts);
+            }
+            break;
+        case QS_QF_NEW_REF:
+        case QS_QF_DELETE_REF:
+        case QS_QF_GC_ATTEMPT:
+        case QS_QF_GC: // TS, sig, pool, refCtr
+            if ((data->nFld < 4U) || (FLD_U(data, 2) == 0U)) {
+                break; // not a dynamic event
+            }
+            if ((FLD_U(data, 3) == 0U) && (data->rec != QS_QF_NEW_REF)) {
+                ++me->nRefErrors; // released without any reference
+            }
+            else if ((data->rec == QS_QF_GC_ATTEMPT)
+                     && (FLD_U(data, 3) < 2U))
+            {
+                ++me->nRefErrors; // should have been recycled
+            }
+            if ((data->rec == QS_QF_GC)
+                && ((e = QSpyEvtLife_sig(me, (uint32_t)FLD_U(data, 1)))
+                    != (QSpyEvtSig *)0))
+            {
+                e->pool = (uint8_t)FLD_U(data, 2);
+                QSpyEvtLife_gc(me, e, ts);
+            }
+            break;
+        default:
+            break;
+    }
+}
+//............................................................................
+void QSpyEvtLife_report(QSpyEvtLife const * const me) {
+    QANA_REPORT_BEGIN();
+    SNPRINTF_LINE("           EvtLife  [ticks] Unmatched=%u,RefErrors=%u,"
+                  "Dropped=%u",
+                  (unsigned)me->nUnmatched,
+                  (unsigned)me->nRefErrors,
+                  (unsigned)me->nDropped);
+    QSPY_printInfo();
+    for (uint32_t i = 0U; i < me->nSigs; ++i) {
+        QSpyEvtSig const * const e = &me->sigs[i];
+        uint64_t const oldest = (e->nLive > 0U)
+                                ? (me->lastTs - e->allocTs[e->head]) : 0U;
+        bool const leak = (e->nLive > 0U) && (oldest >= me->leakAge);
+        SNPRINTF_LINE("           EvtLife  %sSig=%s,Pool=%u,New=%u,Gc=%u,"
+                      "Live=%u,Peak=%u,Oldest=%" PRIu64 ","
+                      "Life(p50=%" PRIu64 ",p99=%" PRIu64 ",max=%" PRIu64
+                      ")",
+                      leak ? "LEAK? " : "",
+                      SigDictionary_get(&QSPY_sigDict, e->sig, 0,
+                                        (char *)0),
+                      (unsigned)e->pool,
+                      (unsigned)e->nNew,
+                      (unsigned)e->nGc,
+                      (unsigned)e->nLive,
+                      (unsigned)e->peakLive,
+                      oldest,
+                      QSpyHist_percentile(&e->lifetime, 50.0),
+                      QSpyHist_percentile(&e->lifetime, 99.0),
+                      e->lifetime.max);
+        if (leak) {
+            QSPY_printError();
+        }
+        else {
+            QSPY_printInfo();
+        }
+    }
+    QANA_REPORT_END();
+}
+
+//============================================================================
+// CPU load profiler...
+
+//............................................................................
+void QSpyCpuLoad_ctor(QSpyCpuLoad * const me, uint64_t window) {
+    memset(me, 0, sizeof(*me));
+    me->window       = window;
+    me->reportOnDone = true;
+}
+//............................................................................
+void QSpyCpuLoad_xtor(QSpyCpuLoad * const me) {
+    QSpyCpuLoad_ctor(me, me->window);
+}
+//............................................................................
+// the owner of the CPU in the given period: the innermost ISR or the task
+static QSpyCpuTime *QSpyCpuLoad_owner(QSpyCpuLoad const * const me,
+                                      QSpyCpuPeriod * const per)
+{
+    if (me->nIsr > 0U) {
+        uint8_t const nest = (me->nIsr <= QSPY_CPU_ISR_NEST_MAX)
+                             ? me->nIsr : QSPY_CPU_ISR_NEST_MAX;
+        return &per->isr[me->isrPri[nest - 1U]];
+    }
+    return &per->task[me->pri];
+}
+//............................................................................
+static void QSpyCpuLoad_charge(QSpyCpuLoad * const me, uint64_t ts) {
+    uint64_t const delta = ts - me->lastTs;
+    QSpyCpuLoad_owner(me, &me->total)->busy += delta;
+    QSpyCpuLoad_owner(me, &me->win)->busy   += delta;
+    me->total.end = ts;
+    me->win.end   = ts;
+    me->lastTs    = ts;
+}
+//............................................................................
+static void QSpyCpuLoad_printWin(QSpyCpuLoad const * const me) {
+    QSpyCpuPeriod const * const w = &me->win;
+    double const time = (w->end > w->beg) ? (double)(w->end - w->beg) : 1.0;
+    QANA_REPORT_BEGIN();
+    SNPRINTF_LINE("           CpuLoad  Win=%u,Beg=%" PRIu64 ","
+                  "Idle=%.1f%%",
+                  (unsigned)me->nWins,
+                  w->beg,
+                  100.0 * (double)w->task[0].busy / time);
+    for (uint32_t p = 1U; p < 256U; ++p) {
+        if (w->task[p].busy > 0U) {
+            SNPRINTF_APPEND(",Pri%u=%.1f%%",
+                            (unsigned)p,
+                            100.0 * (double)w->task[p].busy / time);
+        }
+    }
+    for (uint32_t p = 0U; p < 256U; ++p) {
+        if (w->isr[p].busy > 0U) {
+            SNPRINTF_APPEND(",Isr%u=%.1f%%",
+                            (unsigned)p,
+                            100.0 * (double)w->isr[p].busy / time);
+        }
+    }
+    QSPY_printInfo();
+    QANA_REPORT_END();
+}
+//............................................................................
+static void QSpyCpuLoad_advance(QSpyCpuLoad * const me, uint64_t ts) {
+    if (!me->started) {
+        me->started   = true;
+        me->lastTs    = ts;
+        me->total.beg = ts;
+        me->total.end = ts;
+        me->win.beg   = ts;
+        me->win.end   = ts;
+        return;
+    }
+    if (ts < me->lastTs) { // timestamp out of order?
+        return;
+    }
+    if (me->window > 0U) {
+        // close the windows ending before ts (a longer gap than
+        // QSPY_CPU_WIN_GAP_MAX windows is folded into the last window)
+        for (uint32_t n = 0U;
+             (n < QSPY_CPU_WIN_GAP_MAX)
+                 && (ts - me->win.beg >= me->window);
+             ++n)
+        {
+            QSpyCpuLoad_charge(me, me->win.beg + me->window);
+            QSpyCpuLoad_printWin(me);
+            ++me->nWins;
+            uint64_t const beg = me->win.end;
+            memset(&me->win, 0, sizeof(me->win));
+            me->win.beg = beg;
+            me->win.end = beg;
+        }
+    }
+    QSpyCpuLoad_charge(me, ts);
+}
+//............................................................................
+static void QSpyCpuLoad_count(QSpyCpuLoad * const me, bool isr,
+                              uint8_t pri, bool preempt)
+{
+    QSpyCpuTime * const tot = isr ? &me->total.isr[pri] : &me->total.task[pri];
+    QSpyCpuTime * const win = isr ? &me->win.isr[pri]   : &me->win.task[pri];
+    if (preempt) {
+        ++tot->nPreempt;
+        ++win->nPreempt;
+    }
+    else {
+        ++tot->nRuns;
+        ++win->nRuns;
+    }
+}
+//............................................................................
+void QSpyCpuLoad_onRecord(QSpyCpuLoad * const me, QSpyRecData const *data) {
+    if ((data->rec == QS_TARGET_DONE) && me->reportOnDone) {
+        QSpyCpuLoad_report(me);
+    }
+    if (!data->hasTstamp) {
+        return;
+    }
+    switch (data->rec) {
+        case QS_SCHED_NEXT:    // TS, new pri, prev pri
+        case QS_SCHED_IDLE:    // TS, prev pri
+        case QS_SCHED_PREEMPT: // TS, new pri, preempted pri
+        case QS_SCHED_RESTORE: // TS, restored pri, finished pri
+        case QS_QF_ISR_ENTRY:  // TS, nest, ISR pri
+        case QS_QF_ISR_EXIT:   // TS, nest, ISR pri
+            break;
+        default:
+            return;
+    }
+    if ((data->rec == QS_SCHED_PREEMPT) || (data->rec == QS_SCHED_RESTORE)) {
+        if (QSPY_conf.qpVersion < 710U) {
+            return; // old QS_MUTEX_LOCK/UNLOCK
+        }
+    }
+    if (data->nFld < ((data->rec == QS_SCHED_IDLE) ? 2U : 3U)) {
+        return;
+    }
+
+    QSpyCpuLoad_advance(me, data->tstamp64);
+
+    uint8_t const a = (uint8_t)FLD_U(data, 1);
+    uint8_t const b = (data->rec == QS_SCHED_IDLE)
+                      ? 0U : (uint8_t)FLD_U(data, 2);
+    switch (data->rec) {
+        case QS_SCHED_NEXT:
+            me->pri = a;
+            QSpyCpuLoad_count(me, false, a, false);
+            break;
+        case QS_SCHED_IDLE:
+            me->pri = 0U;
+            QSpyCpuLoad_count(me, false, 0U, false);
+            break;
+        case QS_SCHED_PREEMPT:
+            QSpyCpuLoad_count(me, false, b, true);
+            QSpyCpuLoad_count(me, false, a, false);
+            me->pri = a;
+            break;
+        case QS_SCHED_RESTORE:
+            me->pri = a;
+            break;
+        case QS_QF_ISR_ENTRY:
+            if (me->nIsr > 0U) { // nested ISR?
+                uint8_t const nest = (me->nIsr <= QSPY_CPU_ISR_NEST_MAX)
+                                     ? me->nIsr : QSPY_CPU_ISR_NEST_MAX;
+                QSpyCpuLoad_count(me, true, me->isrPri[nest - 1U], true);
+            }
+            else {
+                QSpyCpuLoad_count(me, false, me->pri, true);
+            }
+            // the nesting reported by the target takes precedence
+            me->nIsr = (a > 0U) ? a : (uint8_t)(me->nIsr + 1U);
+            if (me->nIsr <= QSPY_CPU_ISR_NEST_MAX) {
+                me->isrPri[me->nIsr - 1U] = b;
+            }
+            QSpyCpuLoad_count(me, true, b, false);
+            break;
+        case QS_QF_ISR_EXIT:
+            if (me->nIsr > 0U) {
+                --me->nIsr;
+            }
+            break;
+        default:
+            break;
+    }
+}
+//............................................................................
+// print the entries of the table tbl[256] in the order of decreasing busy
+static void QSpyCpuLoad_printTbl(QSpyCpuTime const tbl[256], bool isr,
+                                 double time)
+{
+    uint64_t busy[256];
+    bool     used[256];
+    uint32_t order[256];
+    for (uint32_t p = 0U; p < 256U; ++p) {
+        busy[p] = tbl[p].busy;
+        used[p] = (tbl[p].busy > 0U) || (tbl[p].nRuns > 0U);
+    }
+    uint32_t const n = QANA_order(busy, used, 256U, order);
+    for (uint32_t i = 0U; i < n; ++i) {
+        uint32_t const top = order[i];
+        SNPRINTF_LINE("           CpuLoad  %s=%u,Busy=%" PRIu64 ","
+                      "Load=%.1f%%,Runs=%u,Preempt=%u",
+                      isr ? "Isr" : "Pri",
+                      (unsigned)top,
+                      tbl[top].busy,
+                      100.0 * (double)tbl[top].busy / time,
+                      (unsigned)tbl[top].nRuns,
+                      (unsigned)tbl[top].nPreempt);
+        QSPY_printInfo();
+    }
+}
+//............................................................................
+void QSpyCpuLoad_report(QSpyCpuLoad const * const me) {
+    QSpyCpuPeriod const * const t = &me->total;
+    uint64_t const span = t->end - t->beg;
+    double const time = (span > 0U) ? (double)span : 1.0;
+    uint64_t isrBusy = 0U;
+    for (uint32_t p = 0U; p < 256U; ++p) {
+        isrBusy += t->isr[p].busy;
+    }
+    QANA_REPORT_BEGIN();
+    SNPRINTF_LINE("           CpuLoad  [ticks] Time=%" PRIu64 ","
+                  "Idle=%.1f%%,Isr=%.1f%%,Windows=%u",
+                  span,
+                  100.0 * (double)t->task[0].busy / time,
+                  100.0 * (double)isrBusy / time,
+                  (unsigned)me->nWins);
+    QSPY_printInfo();
+    QSpyCpuLoad_printTbl(t->task, false, time);
+    QSpyCpuLoad_printTbl(t->isr,  true,  time);
+    QANA_REPORT_END();
+}
+
+//============================================================================
+// critical section analyzer...
+
+static char const * const l_critKindName[QSPY_CRIT_KINDS] = {
+    "Crit",
+    "Int"
+};
+
+//............................................................................
+void QSpyCritSect_ctor(QSpyCritSect * const me, uint64_t limit) {
+    memset(me, 0, sizeof(*me));
+    for (uint32_t k = 0U; k < QSPY_CRIT_KINDS; ++k) {
+        QSpyHist_ctor(&me->kind[k].dur);
+    }
+    me->limit        = limit;
+    me->reportOnDone = true;
+}
+//............................................................................
+void QSpyCritSect_xtor(QSpyCritSect * const me) {
+    for (uint32_t k = 0U; k < QSPY_CRIT_KINDS; ++k) {
+        QSpyHist_xtor(&me->kind[k].dur);
+    }
+    QSpyCritSect_ctor(me, me->limit);
+}
+//............................................................................
+static void QSpyCritSect_enter(QSpyCritSect * const me,
+                               QSpyCritKind * const k,
+                               uint64_t ts, uint8_t nest)
+{
+    bool const outer = (k->nest == 0U) || (nest == 1U);
+    if (outer) {
+        if (k->nest > 0U) { // the exit of the previous section lost?
+            ++k->nUnmatched;
+        }
+        // the records before the entry (oldest first)
+        uint8_t const first = (uint8_t)((me->head + QSPY_CRIT_CTX
+                                         - me->nHist) % QSPY_CRIT_CTX);
+        for (uint8_t i = 0U; i < me->nHist; ++i) {
+            k->cur.before[i] = me->hist[(first + i) % QSPY_CRIT_CTX];
+        }
+        k->cur.nBefore = me->nHist;
+        k->cur.nInside = 0U;
+        k->cur.nAfter  = 0U;
+        k->cur.entryTs = ts;
+        k->prevRec = (me->nHist > 0U)
+            ? me->hist[(me->head + QSPY_CRIT_CTX - 1U) % QSPY_CRIT_CTX].rec
+            : (uint8_t)QS_EMPTY;
+    }
+    // the nesting reported by the target takes precedence
+    k->nest = (nest > 0U)
+              ? nest
+              : ((k->nest < 0xFFU) ? (uint8_t)(k->nest + 1U) : k->nest);
+    if (k->nest > k->maxNest) {
+        k->maxNest = k->nest;
+    }
+}
+//............................................................................
+static void QSpyCritSect_exit(QSpyCritSect * const me,
+                              QSpyCritKind * const k,
+                              uint64_t ts, uint8_t nest)
+{
+    if (k->nest == 0U) { // exit without an entry?
+        ++k->nUnmatched;
+        return;
+    }
+    k->nest = (nest > 0U) ? (uint8_t)(nest - 1U) : (uint8_t)(k->nest - 1U);
+    if (k->nest > 0U) { // still nested?
+        return;
+    }
+    uint64_t const dur = (ts >= k->cur.entryTs) ? (ts - k->cur.entryTs) : 0U;
+    QSpyHist_record(&k->dur, dur);
+    QSpyCritPrev * const p = &k->prev[k->prevRec];
+    ++p->n;
+    p->sum += dur;
+    if (dur > p->max) {
+        p->max = dur;
+    }
+    if ((me->limit > 0U) && (dur > me->limit)) {
+        ++k->nOver;
+    }
+    if ((k->dur.total == 1U) || (dur > k->worst.dur)) {
+        k->worst     = k->cur;
+        k->worst.dur = dur;
+    }
+}
+//............................................................................
+static void QSpyCritSect_ctxPut(QSpyCritCtx * const ctx, uint8_t * const n,
+                                QSpyRecData const *data)
+{
+    if (*n < QSPY_CRIT_CTX) {
+        ctx[*n].rec       = data->rec;
+        ctx[*n].hasTstamp = data->hasTstamp;
+        ctx[*n].ts        = data->tstamp64;
+        ++(*n);
+    }
+}
+//............................................................................
+void QSpyCritSect_onRecord(QSpyCritSect * const me, QSpyRecData const *data) {
+    if ((data->rec == QS_TARGET_DONE) && me->reportOnDone) {
+        QSpyCritSect_report(me);
+    }
+
+    uint32_t kind  = QSPY_CRIT_KINDS;
+    bool     entry = false;
+    switch (data->rec) {
+        case QS_QF_CRIT_ENTRY:
+            entry = true;
+            //lint -fallthrough
+        case QS_QF_CRIT_EXIT:
+            kind = QSPY_CRIT_SECT;
+            break;
+        case QS_QF_INT_DISABLE:
+            entry = true;
+            //lint -fallthrough
+        case QS_QF_INT_ENABLE:
+            kind = QSPY_CRIT_INT;
+            break;
+        default:
+            break;
+    }
+
+    // the context of the sections
+    for (uint32_t i = 0U; i < QSPY_CRIT_KINDS; ++i) {
+        QSpyCritKind * const k = &me->kind[i];
+        if (k->dur.total > 0U) {
+            QSpyCritSect_ctxPut(k->worst.after, &k->worst.nAfter, data);
+        }
+        if ((k->nest > 0U)
+            && !((i == kind) && !entry && (k->nest <= 1U)))
+        {
+            QSpyCritSect_ctxPut(k->cur.inside, &k->cur.nInside, data);
+        }
+    }
+
+    // TS, nest (not decoded without the timestamp and the nesting)
+    if ((kind < QSPY_CRIT_KINDS) && data->hasTstamp && (data->nFld >= 2U)) {
+        uint8_t const nest = (uint8_t)FLD_U(data, 1);
+        if (entry) {
+            QSpyCritSect_enter(me, &me->kind[kind], data->tstamp64, nest);
+        }
+        else {
+            QSpyCritSect_exit(me, &me->kind[kind], data->tstamp64, nest);
+        }
+    }
+
+    me->hist[me->head].rec       = data->rec;
+    me->hist[me->head].hasTstamp = data->hasTstamp;
+    me->hist[me->head].ts        = data->tstamp64;
+    me->head = (uint8_t)((me->head + 1U) % QSPY_CRIT_CTX);
+    if (me->nHist < QSPY_CRIT_CTX) {
+        ++me->nHist;
+    }
+}
+//............................................................................
+static void QSpyCritSect_printCtx(char const *kind, char const *where,
+                                  QSpyCritCtx const *ctx, uint8_t n)
+{
+    SNPRINTF_LINE("           CritSect  Kind=%s,%s:", kind, where);
+    for (uint8_t i = 0U; i < n; ++i) {
+        if (ctx[i].hasTstamp) {
+            SNPRINTF_APPEND(" %s@%" PRIu64,
+                            QSPY_getRecName(ctx[i].rec), ctx[i].ts);
+        }
+        else {
+            SNPRINTF_APPEND(" %s", QSPY_getRecName(ctx[i].rec));
+        }
+    }
+    QSPY_printInfo();
+}
+//............................................................................
+void QSpyCritSect_report(QSpyCritSect const * const me) {
+    QANA_REPORT_BEGIN();
+    for (uint32_t i = 0U; i < QSPY_CRIT_KINDS; ++i) {
+        QSpyCritKind const * const k = &me->kind[i];
+        if ((k->dur.total == 0U) && (k->nUnmatched == 0U)) {
+            continue; // no sections of this kind
+        }
+        SNPRINTF_LINE("           CritSect  [ticks] Kind=%s,N=%" PRIu64 ","
+                      "p50=%" PRIu64 ",p99=%" PRIu64 ",max=%" PRIu64 ","
+                      "MaxNest=%u,Unmatched=%u,Over=%u",
+                      l_critKindName[i],
+                      k->dur.total,
+                      QSpyHist_percentile(&k->dur, 50.0),
+                      QSpyHist_percentile(&k->dur, 99.0),
+                      k->dur.max,
+                      (unsigned)k->maxNest,
+                      (unsigned)k->nUnmatched,
+                      (unsigned)k->nOver);
+        QSPY_printInfo();
+        if (k->dur.total == 0U) {
+            continue;
+        }
+
+        // the worst section with its context
+        SNPRINTF_LINE("           CritSect  Kind=%s,Worst=%" PRIu64 ","
+                      "Entry=%" PRIu64 ",Prev=%s",
+                      l_critKindName[i],
+                      k->worst.dur,
+                      k->worst.entryTs,
+                      QSPY_getRecName(
+                          (k->worst.nBefore > 0U)
+                          ? k->worst.before[k->worst.nBefore - 1U].rec
+                          : (uint8_t)QS_EMPTY));
+        if ((me->limit > 0U) && (k->worst.dur > me->limit)) {
+            QSPY_printError();
+        }
+        else {
+            QSPY_printInfo();
+        }
+        QSpyCritSect_printCtx(l_critKindName[i], "Before",
+                              k->worst.before, k->worst.nBefore);
+        QSpyCritSect_printCtx(l_critKindName[i], "Inside",
+                              k->worst.inside, k->worst.nInside);
+        QSpyCritSect_printCtx(l_critKindName[i], "After",
+                              k->worst.after, k->worst.nAfter);
+
+        // the sections by the preceding record (most frequent first)
+        uint64_t cnt[256];
+        bool     used[256];
+        uint32_t order[256];
+        for (uint32_t r = 0U; r < 256U; ++r) {
+            cnt[r]  = k->prev[r].n;
+            used[r] = (k->prev[r].n > 0U);
+        }
+        uint32_t const n = QANA_order(cnt, used, 256U, order);
+        for (uint32_t j = 0U; j < n; ++j) {
+            uint32_t const top = order[j];
+            SNPRINTF_LINE("           CritSect  Kind=%s,Prev=%s,N=%u,"
+                          "Avg=%" PRIu64 ",Max=%" PRIu64,
+                          l_critKindName[i],
+                          QSPY_getRecName((int)top),
+                          (unsigned)k->prev[top].n,
+                          k->prev[top].sum / k->prev[top].n,
+                          k->prev[top].max);
+            QSPY_printInfo();
+        }
+    }
+    QANA_REPORT_END();
+}
@@ -0,0 +1,953 @@
+//============================================================================
+// QSPY software tracing host-side utility
+//
+//                   Q u a n t u m  L e a P s
+//                   ------------------------
+//                   Modern Embedded Software
+//
+// Copyright(C) 2005 Quantum Leaps, LLC.All rights reserved.
+//
+// This software is licensed under the terms of the Quantum Leaps
+// QSPY SOFTWARE TRACING HOST UTILITY SOFTWARE END USER LICENSE.
+// Please see the file LICENSE-qspy.txt for the complete license text.
+//
+// Quantum Leaps contact information :
+// <www.state-machine.com/licensing>
+// <info@state-machine.com>
+//============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define Q_SPY   1       // this is QS implementation
+#define QP_IMPL 1       // this is QP implementation
+typedef int      int_t;   // dummy definition for including "qpc_qs.h"
+typedef int      enum_t;  // dummy definition for including "qpc_qs.h"
+typedef uint16_t QSignal; // dummy definition for including "qpc_qs.h"
+typedef uint32_t QSFun;   // dummy definition for including "qpc_qs.h"
+typedef uint32_t QSObj;   // dummy definition for including "qpc_qs.h"
+typedef uint32_t QEvt;    // dummy definition for including "qpc_qs.h"
+typedef uint32_t QActive; // dummy definition for including "qpc_qs.h"
+typedef uint32_t QPSet;   // dummy definition for including "qpc_qs.h"
+#include "qpc_qs.h"       // QS target-resident interface
+#include "qpc_qs_pkg.h"   // QS package-scope interface
+
+#include "safe_std.h"   // "safe" <stdio.h> and <string.h> facilities
+#include "qspy.h"       // QSPY data parser
+#include "pal.h"        // Platform Abstraction Layer
+
+// threading facilities ......................................................
+#ifdef _WIN32 // Windows OS?
+
+#include <windows.h>
+
+typedef HANDLE             QENG_Thread;
+typedef CRITICAL_SECTION   QENG_Mutex;
+typedef CONDITION_VARIABLE QENG_Cond;
+
+#define MUTEX_INIT(m_)     InitializeCriticalSection(m_)
+#define MUTEX_DESTROY(m_)  DeleteCriticalSection(m_)
+#define MUTEX_LOCK(m_)     EnterCriticalSection(m_)
+#define MUTEX_UNLOCK(m_)   LeaveCriticalSection(m_)
+#define COND_INIT(c_)      InitializeConditionVariable(c_)
+#define COND_DESTROY(c_)   ((void)0)
+#define COND_WAIT(c_, m_)  SleepConditionVariableCS((c_), (m_), INFINITE)
+#define COND_SIGNAL(c_)    WakeConditionVariable(c_)
+#define COND_BROADCAST(c_) WakeAllConditionVariable(c_)
+
+#else // POSIX (Linux, MacOS, etc.) .......................................
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef pthread_t          QENG_Thread;
+typedef pthread_mutex_t    QENG_Mutex;
+typedef pthread_cond_t     QENG_Cond;
+
+#define MUTEX_INIT(m_)     pthread_mutex_init((m_), NULL)
+#define MUTEX_DESTROY(m_)  pthread_mutex_destroy(m_)
+#define MUTEX_LOCK(m_)     pthread_mutex_lock(m_)
+#define MUTEX_UNLOCK(m_)   pthread_mutex_unlock(m_)
+#define COND_INIT(c_)      pthread_cond_init((c_), NULL)
+#define COND_DESTROY(c_)   pthread_cond_destroy(c_)
+#define COND_WAIT(c_, m_)  pthread_cond_wait((c_), (m_))
+#define COND_SIGNAL(c_)    pthread_cond_signal(c_)
+#define COND_BROADCAST(c_) pthread_cond_broadcast(c_)
+
+#endif // _WIN32
+
+//============================================================================
+// intrusive lock-free multiple-producer single-consumer queue
+// (D. Vyukov's algorithm). Any thread can push, but only one thread
+// (the consumer) can pop.
+typedef struct QENG_Node {
+    struct QENG_Node * _Atomic next;
+} QENG_Node;
+
+typedef struct {
+    QENG_Node * _Atomic head; // the last pushed node (producers)
+    QENG_Node *tail;          // the next node to pop (consumer)
+    QENG_Node  stub;          // dummy node for the empty queue
+} QENG_Queue;
+
+static void QENG_Queue_ctor(QENG_Queue * const me) {
+    atomic_init(&me->stub.next, (QENG_Node *)0);
+    atomic_init(&me->head, &me->stub);
+    me->tail = &me->stub;
+}
+//............................................................................
+static void QENG_Queue_push(QENG_Queue * const me, QENG_Node * const n) {
+    atomic_store_explicit(&n->next, (QENG_Node *)0, memory_order_relaxed);
+    QENG_Node *prev = atomic_exchange_explicit(&me->head, n,
+                                               memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, n, memory_order_release);
+}
+//............................................................................
+// NOTE: can return NULL while a push is in progress (see QENG_Queue_isEmpty)
+static QENG_Node *QENG_Queue_pop(QENG_Queue * const me) {
+    QENG_Node *tail = me->tail;
+    QENG_Node *next = atomic_load_explicit(&tail->next,
+                                           memory_order_acquire);
+    if (tail == &me->stub) { // skip over the stub
+        if (next == (QENG_Node *)0) {
+            return (QENG_Node *)0; // empty
+        }
+        me->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next != (QENG_Node *)0) {
+        me->tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&me->head, memory_order_acquire)) {
+        return (QENG_Node *)0; // a push in progress
+    }
+    QENG_Queue_push(me, &me->stub); // put back the stub to pop the tail
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != (QENG_Node *)0) {
+        me->tail = next;
+        return tail;
+    }
+    return (QENG_Node *)0;
+}
+//............................................................................
+static bool QENG_Queue_isEmpty(QENG_Queue * const me) {
+    return (me->tail == &me->stub)
+        && (atomic_load_explicit(&me->head, memory_order_acquire)
+            == &me->stub);
+}
+
+//============================================================================
+// chunk of raw target bytes posted to a worker
+typedef struct {
+    QENG_Node node;   // inherits QENG_Node
+    uint16_t  stream; // the target stream
+    uint32_t  nBytes; // number of bytes in data[]
+    uint8_t   data[]; // the bytes
+} QENG_Chunk;
+
+// decoded record delivered to the consumer
+typedef struct {
+    QENG_Node node;   // inherits QENG_Node
+    QENG_Rec  rec;    // the public part
+    uint16_t  worker; // the worker owning the node (pool to return to)
+    uint32_t  size;   // capacity of line[] [chars]
+    char      line[]; // storage for the line
+} QENG_RecNode;
+
+enum {
+    QENG_LINE_MIN = 128, // min capacity of the pooled line nodes [chars]
+};
+
+// target stream
+typedef struct {
+    QSpyParser super; // inherits QSpyParser
+    uint16_t   id;    // the stream index
+} QENG_Stream;
+
+// worker thread
+typedef struct {
+    QENG_Queue  inQueue; // chunks to decode
+    QENG_Queue  pool;    // recycled record nodes (pushed by the consumer)
+    QENG_Thread thread;
+    QENG_Mutex  mutex;
+    QENG_Cond   cond;    // signaled when chunks arrive or at stop
+} QENG_Worker;
+
+static struct {
+    QENG_Stream *streams;
+    QENG_Worker *workers;
+    uint16_t     nStreams;
+    uint16_t     nWorkers;
+    QENG_Queue   outQueue; // decoded records
+    atomic_uint  pending;  // number of chunks not decoded yet
+    atomic_uint  dropped;  // lines lost for the lack of memory
+    atomic_bool  running;
+    QENG_Mutex   idleMutex;
+    QENG_Cond    idleCond; // signaled when 'pending' drops to zero
+} l_eng;
+
+//............................................................................
+// output hook of the stream parsers (called in the worker threads)
+static void QENG_onPrintLn(void) {
+    QENG_Stream const * const s = (QENG_Stream const *)QSPY_currParser;
+    uint16_t const worker = (uint16_t)(s->id % l_eng.nWorkers);
+    int len = QSPY_output.len;
+
+    // reuse a node recycled by the consumer, unless it is too small
+    QENG_RecNode *n = (QENG_RecNode *)QENG_Queue_pop(
+                          &l_eng.workers[worker].pool);
+    if ((n != (QENG_RecNode *)0) && (n->size < (uint32_t)len + 1U)) {
+        free(n);
+        n = (QENG_RecNode *)0;
+    }
+    if (n == (QENG_RecNode *)0) {
+        uint32_t size = QENG_LINE_MIN;
+        while (size < (uint32_t)len + 1U) {
+            size *= 2U;
+        }
+        n = (QENG_RecNode *)malloc(sizeof(QENG_RecNode) + size);
+        if (n != (QENG_RecNode *)0) {
+            n->worker = worker;
+            n->size   = size;
+        }
+    }
+    if (n != (QENG_RecNode *)0) {
+        n->rec.stream = s->id;
+        n->rec.rec    = (uint8_t)QSPY_output.rec;
+        n->rec.type   = (uint8_t)QSPY_output.type;
+        n->rec.len    = len;
+        n->rec.line   = n->line;
+        memcpy(n->line, QSPY_line, (size_t)len);
+        n->line[len] = '\0';
+        QENG_Queue_push(&l_eng.outQueue, &n->node);
+    }
+    else {
+        atomic_fetch_add(&l_eng.dropped, 1U);
+    }
+    QSPY_output.type = REG_OUT; // reset the type for the next line
+}
+//............................................................................
+static void QENG_work(QENG_Worker * const w) {
+    for (;;) {
+        QENG_Chunk *c = (QENG_Chunk *)QENG_Queue_pop(&w->inQueue);
+        if (c != (QENG_Chunk *)0) {
+            QSpyParser_parse(&l_eng.streams[c->stream].super,
+                             c->data, c->nBytes);
+            free(c);
+            if (atomic_fetch_sub(&l_eng.pending, 1U) == 1U) { // idle?
+                MUTEX_LOCK(&l_eng.idleMutex);
+                COND_BROADCAST(&l_eng.idleCond);
+                MUTEX_UNLOCK(&l_eng.idleMutex);
+            }
+        }
+        else {
+            MUTEX_LOCK(&w->mutex);
+            while (QENG_Queue_isEmpty(&w->inQueue)
+                   && atomic_load(&l_eng.running))
+            {
+                COND_WAIT(&w->cond, &w->mutex);
+            }
+            MUTEX_UNLOCK(&w->mutex);
+            if (QENG_Queue_isEmpty(&w->inQueue)
+                && !atomic_load(&l_eng.running))
+            {
+                break; // stopped and nothing left to decode
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI QENG_thread(LPVOID arg) {
+    QENG_work((QENG_Worker *)arg);
+    return 0U;
+}
+#else
+static void *QENG_thread(void *arg) {
+    QENG_work((QENG_Worker *)arg);
+    return (void *)0;
+}
+#endif
+
+//============================================================================
+QSpyStatus QENG_start(uint16_t nStreams, uint16_t nWorkers,
+                      QSpyConfig const *config,
+                      QSPY_CustParseFun custParseFun)
+{
+    Q_ASSERT((l_eng.streams == (QENG_Stream *)0)
+             && (nStreams > 0U) && (nWorkers > 0U));
+
+    if (nWorkers > nStreams) { // more workers than streams?
+        nWorkers = nStreams; // extra workers would remain idle
+    }
+    l_eng.streams = (QENG_Stream *)calloc(nStreams, sizeof(QENG_Stream));
+    l_eng.workers = (QENG_Worker *)calloc(nWorkers, sizeof(QENG_Worker));
+    if ((l_eng.streams == (QENG_Stream *)0)
+        || (l_eng.workers == (QENG_Worker *)0))
+    {
+        free(l_eng.streams);
+        free(l_eng.workers);
+        l_eng.streams = (QENG_Stream *)0;
+        l_eng.workers = (QENG_Worker *)0;
+        return QSPY_ERROR;
+    }
+    l_eng.nStreams = nStreams;
+    l_eng.nWorkers = nWorkers;
+
+    QSpyParser * const prev = QSPY_currParser;
+    for (uint16_t i = 0U; i < nStreams; ++i) {
+        QSpyParser * const p = &l_eng.streams[i].super;
+        l_eng.streams[i].id = i;
+        QSpyParser_init(p, config, custParseFun);
+        p->printLnFun = &QENG_onPrintLn;
+        QSPY_currParser = p;
+        QSPY_resetAllDictionaries();
+    }
+    QSPY_currParser = prev;
+
+    QENG_Queue_ctor(&l_eng.outQueue);
+    atomic_init(&l_eng.pending, 0U);
+    atomic_init(&l_eng.dropped, 0U);
+    atomic_init(&l_eng.running, true);
+    MUTEX_INIT(&l_eng.idleMutex);
+    COND_INIT(&l_eng.idleCond);
+
+    for (uint16_t i = 0U; i < nWorkers; ++i) {
+        QENG_Queue_ctor(&l_eng.workers[i].inQueue);
+        QENG_Queue_ctor(&l_eng.workers[i].pool);
+    }
+    for (uint16_t i = 0U; i < nWorkers; ++i) {
+        QENG_Worker * const w = &l_eng.workers[i];
+        MUTEX_INIT(&w->mutex);
+        COND_INIT(&w->cond);
+#ifdef _WIN32
+        w->thread = CreateThread(NULL, 0, &QENG_thread, w, 0, NULL);
+        bool const ok = (w->thread != NULL);
+#else
+        bool const ok =
+            (pthread_create(&w->thread, NULL, &QENG_thread, w) == 0);
+#endif
+        if (!ok) { // stop the workers already started and clean up
+            MUTEX_DESTROY(&w->mutex);
+            COND_DESTROY(&w->cond);
+            l_eng.nWorkers = i;
+            QENG_stop();
+            return QSPY_ERROR;
+        }
+    }
+    return QSPY_SUCCESS;
+}
+//............................................................................
+void QENG_stop(void) {
+    if (l_eng.streams == (QENG_Stream *)0) { // not started?
+        return;
+    }
+    atomic_store(&l_eng.running, false);
+    for (uint16_t i = 0U; i < l_eng.nWorkers; ++i) {
+        QENG_Worker * const w = &l_eng.workers[i];
+        MUTEX_LOCK(&w->mutex);
+        COND_SIGNAL(&w->cond);
+        MUTEX_UNLOCK(&w->mutex);
+    }
+    for (uint16_t i = 0U; i < l_eng.nWorkers; ++i) {
+        QENG_Worker * const w = &l_eng.workers[i];
+#ifdef _WIN32
+        WaitForSingleObject(w->thread, INFINITE);
+        CloseHandle(w->thread);
+#else
+        pthread_join(w->thread, NULL);
+#endif
+        MUTEX_DESTROY(&w->mutex);
+        COND_DESTROY(&w->cond);
+    }
+
+    // discard the records not retrieved by the consumer
+    QENG_Node *n;
+    while ((n = QENG_Queue_pop(&l_eng.outQueue)) != (QENG_Node *)0) {
+        free(n);
+    }
+    for (uint16_t i = 0U; i < l_eng.nWorkers; ++i) { // the pooled nodes
+        while ((n = QENG_Queue_pop(&l_eng.workers[i].pool))
+               != (QENG_Node *)0)
+        {
+            free(n);
+        }
+    }
+    MUTEX_DESTROY(&l_eng.idleMutex);
+    COND_DESTROY(&l_eng.idleCond);
+
+    for (uint16_t i = 0U; i < l_eng.nStreams; ++i) {
+        QSpyParser_xtor(&l_eng.streams[i].super);
+    }
+    free(l_eng.streams);
+    free(l_eng.workers);
+    l_eng.streams  = (QENG_Stream *)0;
+    l_eng.workers  = (QENG_Worker *)0;
+    l_eng.nStreams = 0U;
+    l_eng.nWorkers = 0U;
+}
+//............................................................................
+QSpyParser *QENG_getParser(uint16_t stream) {
+    Q_ASSERT(stream < l_eng.nStreams);
+    return &l_eng.streams[stream].super;
+}
+//............................................................................
+// NOTE: the bytes of one stream must be posted from one thread only,
+// to preserve their order
+QSpyStatus QENG_post(uint16_t stream, uint8_t const *buf, uint32_t nBytes) {
+    Q_ASSERT(stream < l_eng.nStreams);
+
+    QENG_Chunk *c = (QENG_Chunk *)malloc(sizeof(QENG_Chunk) + nBytes);
+    if (c == (QENG_Chunk *)0) {
+        return QSPY_ERROR;
+    }
+    c->stream = stream;
+    c->nBytes = nBytes;
+    memcpy(c->data, buf, nBytes);
+
+    // the stream is always decoded by the same worker
+    QENG_Worker * const w = &l_eng.workers[stream % l_eng.nWorkers];
+    atomic_fetch_add(&l_eng.pending, 1U);
+    QENG_Queue_push(&w->inQueue, &c->node);
+    MUTEX_LOCK(&w->mutex);
+    COND_SIGNAL(&w->cond);
+    MUTEX_UNLOCK(&w->mutex);
+
+    return QSPY_SUCCESS;
+}
+//............................................................................
+// NOTE: must be called from one (consumer) thread only
+QENG_Rec const *QENG_get(void) {
+    QENG_RecNode *n = (QENG_RecNode *)QENG_Queue_pop(&l_eng.outQueue);
+    return (n != (QENG_RecNode *)0) ? &n->rec : (QENG_Rec const *)0;
+}
+//............................................................................
+// NOTE: the nodes go back to the pools of their workers for reuse.
+// The records recycled after QENG_stop() are freed instead, unless the
+// engine has been started again with their worker (any pool will do).
+void QENG_recycle(QENG_Rec const *rec) {
+    QENG_RecNode * const n =
+        (QENG_RecNode *)((char *)rec - offsetof(QENG_RecNode, rec));
+    if ((l_eng.workers == (QENG_Worker *)0)
+        || (n->worker >= l_eng.nWorkers))
+    {
+        free(n); // the pools of the engine are gone
+        return;
+    }
+    QENG_Queue_push(&l_eng.workers[n->worker].pool, &n->node);
+}
+//............................................................................
+// number of the decoded lines lost for the lack of memory (by the streams
+// since QENG_start() and by the chunks of QENG_decodeFile())
+uint32_t QENG_getDropped(void) {
+    return (uint32_t)atomic_load(&l_eng.dropped);
+}
+//............................................................................
+// wait until all the posted bytes have been decoded
+void QENG_flush(void) {
+    MUTEX_LOCK(&l_eng.idleMutex);
+    while (atomic_load(&l_eng.pending) != 0U) {
+        COND_WAIT(&l_eng.idleCond, &l_eng.idleMutex);
+    }
+    MUTEX_UNLOCK(&l_eng.idleMutex);
+}
+
+//============================================================================
+// offline decoding of capture files...
+enum {
+    QENG_FILE_CHUNK  = 8*1024*1024, // nominal size of a file chunk [bytes]
+    QENG_FILE_WINDOW = 4,  // chunks in flight per worker
+    QENG_SEQ_LOOKBACK = 64, // max frames searched back for the chunk seq
+};
+
+// chunk of a mapped capture file and its decoded output
+typedef struct {
+    uint8_t const *data;   // the chunk in the mapped file
+    size_t         nBytes; // size of the chunk
+    int            seq;    // seq of the preceding healthy record (or -1)
+    QSpyParser const *proto; // dictionaries at the start of the chunk
+    QSpyParser    *snap;   // snapshot owned by this chunk (or NULL)
+
+    QSpyBatchLine *lines;    // decoded lines (the text is in text[])
+    uint32_t       nLines;
+    uint32_t       maxLines;
+    char          *text;     // zero-terminated lines one after another
+    size_t         textLen;
+    size_t         textSize;
+    atomic_bool    done;     // the chunk has been decoded
+} QENG_FileChunk;
+
+static struct {
+    QENG_FileChunk   *chunks;
+    size_t            nChunks;
+    size_t            preChunk;  // chunk in the pre-pass
+    size_t            firstOpen; // first chunk without the proto yet
+    bool              snapFailed; // a snapshot could not be allocated
+    atomic_size_t     next;    // next chunk to decode
+    size_t            written; // chunks already delivered to the output
+    size_t            window;  // max chunks decoded ahead of 'written'
+    uint32_t          recordSize; // max size of the records in the file
+    QENG_Mutex        mutex;
+    QENG_Cond         cond;    // signaled when a chunk is done or written
+} l_file;
+
+//............................................................................
+// map the whole file into memory, returns NULL for an empty/missing file
+static uint8_t const *QENG_mapFile(char const *fName, size_t *pSize) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return (uint8_t const *)0;
+    }
+    LARGE_INTEGER size;
+    void *data = NULL;
+    if (GetFileSizeEx(file, &size) && (size.QuadPart > 0)) {
+        HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY,
+                                        0, 0, NULL);
+        if (map != NULL) {
+            data = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(map); // the view keeps the mapping alive
+        }
+    }
+    CloseHandle(file);
+    *pSize = (data != NULL) ? (size_t)size.QuadPart : 0U;
+    return (uint8_t const *)data;
+#else
+    int fd = open(fName, O_RDONLY);
+    if (fd < 0) {
+        return (uint8_t const *)0;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd); // the mapping stays valid
+    if (data == MAP_FAILED) {
+        return (uint8_t const *)0;
+    }
+    *pSize = (size_t)st.st_size;
+    return (uint8_t const *)data;
+#endif
+}
+//............................................................................
+static void QENG_unmapFile(uint8_t const *data, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap((void *)data, size);
+#endif
+}
+//............................................................................
+// snapshot of the pre-pass dictionaries before the session ends, for the
+// chunks that start since the previous session end (or the capture start)
+static void QENG_snapshot(void) {
+    if (l_file.firstOpen > l_file.preChunk) {
+        return; // no chunk starts since the previous session end
+    }
+    QSpyParser *snap = (QSpyParser *)calloc(1U, sizeof(QSpyParser));
+    if (snap == (QSpyParser *)0) {
+        l_file.snapFailed = true;
+        return;
+    }
+    QSpyParser_clone(snap, QSPY_currParser);
+    l_file.chunks[l_file.preChunk].snap = snap;
+    for (size_t k = l_file.firstOpen; k <= l_file.preChunk; ++k) {
+        l_file.chunks[k].proto = snap;
+    }
+    l_file.firstOpen = l_file.preChunk + 1U;
+}
+//............................................................................
+// pre-pass filter: only the records that update the target configuration
+// and the dictionaries are processed
+static int QENG_dictOnly(QSpyRecord * const me) {
+    switch (me->rec) {
+        case QS_SIG_DICT:
+        case QS_OBJ_DICT:
+        case QS_FUN_DICT:
+        case QS_USR_DICT:
+        case QS_ENUM_DICT:
+            return 1;
+        case QS_TARGET_INFO:
+            if (QSpyRecord_isSessionEnd(me)) {
+                QENG_snapshot(); // before the dictionaries are discarded
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+//............................................................................
+// sequence number of the last healthy record ending before the frame byte
+// data[end], or -1 if not found. Used to seed the discontinuity check of
+// a chunk as if the capture was decoded sequentially.
+static int QENG_prevSeq(uint8_t const *data, size_t end,
+                        uint32_t recordSize)
+{
+    for (int n = 0; n < QENG_SEQ_LOOKBACK; ++n) {
+        size_t beg = end; // find the start of the frame ending at data[end]
+        while ((beg > 0U) && (data[beg - 1U] != QS_FRAME)) {
+            --beg;
+        }
+        // un-escape the frame and verify it like QSpyParser_parse() does
+        uint8_t sum = 0U;
+        uint8_t seq = 0U;
+        size_t  len = 0U;
+        bool    esc = false;
+        for (size_t i = beg; i < end; ++i) {
+            uint8_t b = data[i];
+            if (esc) {
+                b ^= QS_ESC_XOR;
+                esc = false;
+            }
+            else if (b == QS_ESC) {
+                esc = true;
+                continue;
+            }
+            if (len == 0U) {
+                seq = b;
+            }
+            sum = (uint8_t)(sum + b);
+            ++len;
+        }
+        if ((sum == QS_GOOD_CHKSUM) && (len >= 3U)
+            && (len <= recordSize))
+        {
+            return seq;
+        }
+        if (beg == 0U) {
+            break; // beginning of the capture
+        }
+        end = beg - 1U;
+    }
+    return -1;
+}
+//............................................................................
+// output hook of the chunk parsers (called in the worker threads)
+static void QENG_onChunkLn(void) {
+    QENG_FileChunk * const c = (QENG_FileChunk *)QSPY_currParser->ctx;
+    size_t len = (size_t)QSPY_output.len;
+
+    if (c->nLines == c->maxLines) { // grow the lines?
+        uint32_t max = (c->maxLines > 0U) ? 2U*c->maxLines : 1024U;
+        QSpyBatchLine *lines = (QSpyBatchLine *)realloc(c->lines,
+                                   max * sizeof(QSpyBatchLine));
+        if (lines == (QSpyBatchLine *)0) {
+            atomic_fetch_add(&l_eng.dropped, 1U);
+            QSPY_output.type = REG_OUT;
+            return; // line lost
+        }
+        c->lines    = lines;
+        c->maxLines = max;
+    }
+    if (c->textLen + len + 1U > c->textSize) { // grow the text?
+        size_t size = (c->textSize > 0U) ? 2U*c->textSize : 64U*1024U;
+        while (c->textLen + len + 1U > size) {
+            size *= 2U;
+        }
+        char *text = (char *)realloc(c->text, size);
+        if (text == (char *)0) {
+            atomic_fetch_add(&l_eng.dropped, 1U);
+            QSPY_output.type = REG_OUT;
+            return; // line lost
+        }
+        c->text     = text;
+        c->textSize = size;
+    }
+    QSpyBatchLine *ln = &c->lines[c->nLines];
+    ++c->nLines;
+    ln->rec  = QSPY_output.rec;
+    ln->type = QSPY_output.type;
+    ln->len  = (int)len;
+    ln->line = (char const *)0; // set when the text stops moving
+    memcpy(&c->text[c->textLen], QSPY_line, len);
+    c->text[c->textLen + len] = '\0';
+    c->textLen += len + 1U;
+
+    QSPY_output.type = REG_OUT; // reset the type for the next line
+}
+//............................................................................
+static void QENG_decodeChunks(QSpyParser * const p) {
+    for (;;) {
+        size_t k = atomic_fetch_add(&l_file.next, 1U);
+        if (k >= l_file.nChunks) {
+            break;
+        }
+        // stay within the window of chunks ahead of the output
+        MUTEX_LOCK(&l_file.mutex);
+        while (k >= l_file.written + l_file.window) {
+            COND_WAIT(&l_file.cond, &l_file.mutex);
+        }
+        MUTEX_UNLOCK(&l_file.mutex);
+
+        QENG_FileChunk * const c = &l_file.chunks[k];
+        QSpyParser_clone(p, c->proto);
+        p->printLnFun = &QENG_onChunkLn;
+        p->ctx = c;
+        if (c->seq >= 0) { // continue the sequence of the previous chunk
+            p->isJustStarted = false;
+            p->seq = (uint8_t)c->seq;
+        }
+        size_t off = 0U;
+        while (off < c->nBytes) { // QSpyParser_parse() takes uint32_t
+            uint32_t n = (c->nBytes - off > 0x40000000U)
+                         ? 0x40000000U
+                         : (uint32_t)(c->nBytes - off);
+            QSpyParser_parse(p, &c->data[off], n);
+            off += n;
+        }
+        QSpyParser_xtor(p);
+
+        MUTEX_LOCK(&l_file.mutex);
+        atomic_store(&c->done, true);
+        COND_BROADCAST(&l_file.cond);
+        MUTEX_UNLOCK(&l_file.mutex);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI QENG_fileThread(LPVOID arg) {
+    QENG_decodeChunks((QSpyParser *)arg);
+    return 0U;
+}
+#else
+static void *QENG_fileThread(void *arg) {
+    QENG_decodeChunks((QSpyParser *)arg);
+    return (void *)0;
+}
+#endif
+
+//............................................................................
+// parse the bytes of the capture, which can exceed the uint32_t range
+static void QENG_parseAll(QSpyParser * const p,
+                          uint8_t const *data, size_t size)
+{
+    for (size_t off = 0U; off < size; ) {
+        uint32_t n = (size - off > 0x40000000U)
+                     ? 0x40000000U : (uint32_t)(size - off);
+        QSpyParser_parse(p, &data[off], n);
+        off += n;
+    }
+}
+//............................................................................
+// free the pre-pass snapshots and the decoded output of all the chunks
+static void QENG_freeChunks(void) {
+    for (size_t k = 0U; k < l_file.nChunks; ++k) {
+        QENG_FileChunk * const c = &l_file.chunks[k];
+        if (c->snap != (QSpyParser *)0) {
+            QSpyParser_xtor(c->snap);
+            free(c->snap);
+            c->snap = (QSpyParser *)0;
+        }
+        free(c->lines);
+        free(c->text);
+        c->lines = (QSpyBatchLine *)0;
+        c->text  = (char *)0;
+    }
+}
+//............................................................................
+// NOTE: the pre-pass processes all the dictionary and target-info records
+// of the capture first, so that every chunk is decoded with the (final)
+// configuration and dictionaries of the target session it starts in.
+// A session ends with a target reset or a change of the target
+// configuration (see QSpyRecord_isSessionEnd()), before which the pre-pass
+// takes a snapshot of the dictionaries for the chunks starting in that
+// session. A chunk spanning the session end processes it itself, as when
+// decoding sequentially. Without the memory for the snapshots, the capture
+// is decoded sequentially as one chunk. The max record size is taken from
+// the current parser of the caller (see QSPY_configRecordSize()).
+QSpyStatus QENG_decodeFile(char const *fName, uint16_t nWorkers,
+                           QSpyConfig const *config,
+                           QSPY_CustParseFun custParseFun,
+                           QENG_OutFun outFun, void *arg)
+{
+    Q_ASSERT((nWorkers > 0U) && (outFun != (QENG_OutFun)0));
+
+    size_t size = 0U;
+    uint8_t const *data = QENG_mapFile(fName, &size);
+    if (data == (uint8_t const *)0) {
+        return QSPY_ERROR;
+    }
+
+    // split the capture after QS_FRAME bytes (boundaries of the records)
+    size_t nChunks = 0U;
+    for (size_t beg = 0U; beg < size; ++nChunks) {
+        size_t end = (size - beg > QENG_FILE_CHUNK)
+                     ? beg + QENG_FILE_CHUNK : size;
+        while ((end < size) && (data[end - 1U] != QS_FRAME)) {
+            ++end;
+        }
+        beg = end;
+    }
+    l_file.chunks = (QENG_FileChunk *)calloc(nChunks, sizeof(QENG_FileChunk));
+    QSpyParser *proto = (QSpyParser *)calloc(1U, sizeof(QSpyParser));
+    QSpyParser *parsers = (QSpyParser *)calloc(nWorkers, sizeof(QSpyParser));
+    QENG_Thread *threads = (QENG_Thread *)calloc(nWorkers,
+                                                 sizeof(QENG_Thread));
+    if ((l_file.chunks == (QENG_FileChunk *)0)
+        || (proto == (QSpyParser *)0)
+        || (parsers == (QSpyParser *)0)
+        || (threads == (QENG_Thread *)0))
+    {
+        free(l_file.chunks);
+        l_file.chunks = (QENG_FileChunk *)0;
+        free(proto);
+        free(parsers);
+        free(threads);
+        QENG_unmapFile(data, size);
+        return QSPY_ERROR;
+    }
+    l_file.nChunks = nChunks;
+    l_file.recordSize = QSPY_currParser->recordSize;
+    size_t beg = 0U;
+    for (size_t k = 0U; k < nChunks; ++k) {
+        QENG_FileChunk * const c = &l_file.chunks[k];
+        size_t end = (size - beg > QENG_FILE_CHUNK)
+                     ? beg + QENG_FILE_CHUNK : size;
+        while ((end < size) && (data[end - 1U] != QS_FRAME)) {
+            ++end;
+        }
+        c->data   = &data[beg];
+        c->nBytes = end - beg;
+        c->seq    = (beg > 0U)
+                    ? QENG_prevSeq(data, beg - 1U, l_file.recordSize)
+                    : -1;
+        atomic_init(&c->done, false);
+        beg = end;
+    }
+
+    // pre-pass: the target configuration and the dictionaries
+    QSpyParser * const prev = QSPY_currParser;
+    QSpyParser_init(proto, config, &QENG_dictOnly);
+    (void)QSpyParser_configRecordSize(proto, l_file.recordSize);
+    proto->textOn = false;
+    QSPY_currParser = proto;
+    QSPY_resetAllDictionaries();
+    QSPY_currParser = prev;
+    l_file.firstOpen  = 0U;
+    l_file.snapFailed = false;
+    for (size_t k = 0U; (k < nChunks) && !l_file.snapFailed; ++k) {
+        l_file.preChunk = k;
+        QENG_parseAll(proto, l_file.chunks[k].data, l_file.chunks[k].nBytes);
+    }
+    if (l_file.snapFailed) { // fall back to the sequential decoding
+        QENG_freeChunks();
+        QSpyParser_xtor(proto);
+        QSpyParser_init(proto, config, custParseFun);
+        (void)QSpyParser_configRecordSize(proto, l_file.recordSize);
+        QSPY_currParser = proto;
+        QSPY_resetAllDictionaries();
+        QSPY_currParser = prev;
+        nChunks = 1U;
+        l_file.nChunks = nChunks;
+        l_file.chunks[0].nBytes = size;
+        l_file.chunks[0].proto  = proto;
+    }
+    else {
+        for (size_t k = l_file.firstOpen; k < nChunks; ++k) {
+            l_file.chunks[k].proto = proto; // the last session
+        }
+        for (size_t k = 0U; k < nChunks; ++k) {
+            QSpyParser * const snap = l_file.chunks[k].snap;
+            if (snap != (QSpyParser *)0) {
+                snap->custParseFun = custParseFun;
+                snap->textOn = true;
+            }
+        }
+    }
+    proto->custParseFun = custParseFun;
+    proto->textOn = true;
+
+    // parallel decoding of the chunks
+    l_file.written = 0U;
+    l_file.window  = (size_t)nWorkers * QENG_FILE_WINDOW;
+    atomic_init(&l_file.next, 0U);
+    MUTEX_INIT(&l_file.mutex);
+    COND_INIT(&l_file.cond);
+
+    QSpyStatus status = QSPY_SUCCESS;
+    uint16_t nThreads = 0U;
+    for (; nThreads < nWorkers; ++nThreads) {
+#ifdef _WIN32
+        threads[nThreads] = CreateThread(NULL, 0, &QENG_fileThread,
+                                         &parsers[nThreads], 0, NULL);
+        if (threads[nThreads] == NULL) {
+            status = QSPY_ERROR;
+            break;
+        }
+#else
+        if (pthread_create(&threads[nThreads], NULL, &QENG_fileThread,
+                           &parsers[nThreads]) != 0)
+        {
+            status = QSPY_ERROR;
+            break;
+        }
+#endif
+    }
+    if (status != QSPY_SUCCESS) { // let the created threads finish
+        atomic_store(&l_file.next, nChunks);
+        MUTEX_LOCK(&l_file.mutex);
+        l_file.written = nChunks; // release the threads waiting for window
+        COND_BROADCAST(&l_file.cond);
+        MUTEX_UNLOCK(&l_file.mutex);
+    }
+
+    // deliver the decoded chunks in order
+    for (size_t k = 0U; (k < nChunks) && (status == QSPY_SUCCESS); ++k) {
+        QENG_FileChunk * const c = &l_file.chunks[k];
+        MUTEX_LOCK(&l_file.mutex);
+        while (!atomic_load(&c->done)) {
+            COND_WAIT(&l_file.cond, &l_file.mutex);
+        }
+        MUTEX_UNLOCK(&l_file.mutex);
+
+        size_t off = 0U;
+        for (uint32_t i = 0U; i < c->nLines; ++i) {
+            c->lines[i].line = &c->text[off];
+            off += (size_t)c->lines[i].len + 1U;
+        }
+        if (c->nLines > 0U) {
+            (*outFun)(c->lines, c->nLines, arg);
+        }
+        free(c->lines);
+        free(c->text);
+        c->lines = (QSpyBatchLine *)0;
+        c->text  = (char *)0;
+
+        MUTEX_LOCK(&l_file.mutex);
+        l_file.written = k + 1U;
+        COND_BROADCAST(&l_file.cond);
+        MUTEX_UNLOCK(&l_file.mutex);
+    }
+
+    for (uint16_t i = 0U; i < nThreads; ++i) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    free(threads);
+    free(parsers);
+    MUTEX_DESTROY(&l_file.mutex);
+    COND_DESTROY(&l_file.cond);
+
+    QENG_freeChunks(); // any output left undelivered
+    QSpyParser_xtor(proto);
+    free(proto);
+    free(l_file.chunks);
+    l_file.chunks  = (QENG_FileChunk *)0;
+    l_file.nChunks = 0U;
+    QENG_unmapFile(data, size);
+    return status;
+}
@@ -0,0 +1,355 @@
+//============================================================================
+// QSPY software tracing host-side utility
+//
+//                   Q u a n t u m  L e a P s
+//                   ------------------------
+//                   Modern Embedded Software
+//
+// Copyright(C) 2005 Quantum Leaps, LLC.All rights reserved.
+//
+// This software is licensed under the terms of the Quantum Leaps
+// QSPY SOFTWARE TRACING HOST UTILITY SOFTWARE END USER LICENSE.
+// Please see the file LICENSE-qspy.txt for the complete license text.
+//
+// Quantum Leaps contact information :
+// <www.state-machine.com/licensing>
+// <info@state-machine.com>
+//============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define Q_SPY   1       // this is QS implementation
+#define QP_IMPL 1       // this is QP implementation
+typedef int      int_t;   // dummy definition for including "qpc_qs.h"
+typedef int      enum_t;  // dummy definition for including "qpc_qs.h"
+typedef uint16_t QSignal; // dummy definition for including "qpc_qs.h"
+typedef uint32_t QSFun;   // dummy definition for including "qpc_qs.h"
+typedef uint32_t QSObj;   // dummy definition for including "qpc_qs.h"
+typedef uint32_t QEvt;    // dummy definition for including "qpc_qs.h"
+typedef uint32_t QActive; // dummy definition for including "qpc_qs.h"
+typedef uint32_t QPSet;   // dummy definition for including "qpc_qs.h"
+#include "qpc_qs.h"       // QS target-resident interface
+#include "qpc_qs_pkg.h"   // QS package-scope interface
+
+#include "safe_std.h"   // "safe" <stdio.h> and <string.h> facilities
+#include "qspy.h"       // QSPY data parser
+#include "pal.h"        // Platform Abstraction Layer
+
+//............................................................................
+static bool QSpyFlightRec_isSticky(uint8_t rec) {
+    switch (rec) {
+        case QS_ENUM_DICT:
+        case QS_SIG_DICT:
+        case QS_OBJ_DICT:
+        case QS_FUN_DICT:
+        case QS_USR_DICT:
+        case QS_TARGET_INFO:
+            return true;
+        default:
+            return false;
+    }
+}
+//............................................................................
+static bool QSpyFlightRec_isTrigger(QSpyFlightRec const * const me,
+                                    uint8_t rec)
+{
+    return (rec < 128U)
+           && ((me->trigMask[rec >> 5U] & (1U << (rec & 0x1FU))) != 0U);
+}
+
+//............................................................................
+QSpyStatus QSpyFlightRec_ctor(QSpyFlightRec * const me,
+                              size_t ringSize, char const *prefix)
+{
+    Q_ASSERT(ringSize > 0U);
+
+    memset(me, 0, sizeof(*me));
+    me->ring = (uint8_t *)malloc(ringSize);
+    if (me->ring == (uint8_t *)0) {
+        return QSPY_ERROR;
+    }
+    me->size   = ringSize;
+    me->prefix = (prefix != (char const *)0) ? prefix : "qspy_fr";
+    QSpyFlightRec_configTrigger(me, QS_ASSERT_FAIL, true);
+    QSpyFlightRec_configTrigger(me, QS_TARGET_DONE, true);
+    return QSPY_SUCCESS;
+}
+//............................................................................
+void QSpyFlightRec_xtor(QSpyFlightRec * const me) {
+    free(me->ring);
+    free(me->sticky);
+    me->ring   = (uint8_t *)0;
+    me->sticky = (uint8_t *)0;
+    me->size   = 0U;
+    me->stickyLen  = 0U;
+    me->stickySize = 0U;
+}
+//............................................................................
+void QSpyFlightRec_configTrigger(QSpyFlightRec * const me,
+                                 uint8_t rec, bool on)
+{
+    Q_ASSERT(rec < 128U);
+
+    if (on) {
+        me->trigMask[rec >> 5U] |= (1U << (rec & 0x1FU));
+    }
+    else {
+        me->trigMask[rec >> 5U] &= ~(1U << (rec & 0x1FU));
+    }
+}
+
+//............................................................................
+// append the frame [beg..end) of the stream from the ring to the sticky[]
+// and check it. Returns false (and takes the frame back out of sticky[])
+// if the frame is no longer in the ring or it is corrupted.
+static bool QSpyFlightRec_keep(QSpyFlightRec * const me,
+                               uint64_t beg, uint64_t end)
+{
+    size_t n = (size_t)(end - beg);
+    if ((beg + me->size < me->total)
+        || (me->stickyLen + n > QSPY_FLIGHT_STICKY_MAX))
+    {
+        return false; // overwritten in the ring or no room
+    }
+    if (me->stickyLen + n > me->stickySize) { // grow the sticky[]?
+        size_t size = (me->stickySize > 0U) ? 2U*me->stickySize : 4096U;
+        while (me->stickyLen + n > size) {
+            size *= 2U;
+        }
+        uint8_t *sticky = (uint8_t *)realloc(me->sticky, size);
+        if (sticky == (uint8_t *)0) {
+            return false;
+        }
+        me->sticky     = sticky;
+        me->stickySize = size;
+    }
+
+    uint8_t *dst = &me->sticky[me->stickyLen];
+    size_t at = (size_t)(beg % me->size);
+    size_t n1 = (me->size - at < n) ? (me->size - at) : n;
+    memcpy(dst, &me->ring[at], n1);
+    memcpy(&dst[n1], me->ring, n - n1);
+
+    // un-escape and check the frame (the last byte is QS_FRAME)
+    uint8_t chksum = 0U;
+    uint8_t esc    = 0U;
+    uint32_t len   = 0U;
+    for (size_t i = 0U; i + 1U < n; ++i) {
+        uint8_t b = dst[i];
+        if (b == QS_ESC) {
+            esc = 1U;
+        }
+        else {
+            if (esc != 0U) {
+                b ^= QS_ESC_XOR;
+                esc = 0U;
+            }
+            chksum = (uint8_t)(chksum + b);
+            ++len;
+        }
+    }
+    if ((len < 3U) || (chksum != QS_GOOD_CHKSUM)) {
+        return false; // not a healthy record
+    }
+    me->stickyLen += n;
+    return true;
+}
+//............................................................................
+// the frame [me->frameBeg..end) of the stream has just ended
+static void QSpyFlightRec_frameEnd(QSpyFlightRec * const me, uint64_t end) {
+    if (me->hdr == 2U) { // complete header?
+        if (QSpyFlightRec_isSticky(me->rec)) {
+            size_t len0 = me->stickyLen;
+            if (QSpyFlightRec_keep(me, me->frameBeg, end)
+                && (me->rec == QS_TARGET_INFO))
+            {
+                // the first data byte of QS_TARGET_INFO (after seq/rec)
+                uint8_t const *p = &me->sticky[len0];
+                size_t i = (p[0] == QS_ESC) ? 2U : 1U;   // skip seq
+                i += (p[i] == QS_ESC) ? 2U : 1U;         // skip rec
+                uint8_t a = (p[i] == QS_ESC)
+                            ? (uint8_t)(p[i + 1U] ^ QS_ESC_XOR)
+                            : p[i];
+                bool isReset = ((a & 0x03U) == 0x02U)
+                               ? (((a >> 6U) & 0x01U) != 0U)
+                               : ((a & 0x01U) != 0U);
+                if (isReset) { // target reset? keep only this target-info
+                    memmove(me->sticky, p, me->stickyLen - len0);
+                    me->stickyLen -= len0;
+                }
+            }
+        }
+        else if (QSpyFlightRec_isTrigger(me, me->rec)) {
+            size_t len0 = me->stickyLen;
+            if (QSpyFlightRec_keep(me, me->frameBeg, end)) {
+                ++me->pending; // dumped later by QSpyFlightRec_poll()
+            }
+            me->stickyLen = len0; // checked only, not kept
+        }
+    }
+    me->frameBeg = end;
+    me->hdr = 0U;
+    me->esc = 0U;
+    me->rec = 0U;
+}
+
+//............................................................................
+// NOTE: the steady-state cost is the copy of the buffer into the ring and
+// the search for the QS_FRAME bytes. The frames are inspected only when
+// they carry the dictionary, target-info, or trigger records. The dumps
+// are deferred to QSpyFlightRec_poll().
+void QSpyFlightRec_put(QSpyFlightRec * const me,
+                       uint8_t const *buf, uint32_t nBytes)
+{
+    uint64_t const base = me->total;
+
+    // copy the buffer into the ring (only the last me->size bytes)
+    uint8_t const *src = buf;
+    size_t n = nBytes;
+    if (n > me->size) {
+        src = &buf[n - me->size];
+        n   = me->size;
+    }
+    size_t at = (size_t)((base + (nBytes - n)) % me->size);
+    size_t n1 = (me->size - at < n) ? (me->size - at) : n;
+    memcpy(&me->ring[at], src, n1);
+    memcpy(me->ring, &src[n1], n - n1);
+    me->total = base + nBytes;
+
+    // scan the buffer for the frame boundaries
+    uint8_t const *p   = buf;
+    uint8_t const *end = &buf[nBytes];
+    while (p < end) {
+        if (me->hdr < 2U) { // header of the frame (seq and record ID)?
+            uint8_t b = *p;
+            if (b == QS_FRAME) {
+                QSpyFlightRec_frameEnd(me, base + (uint64_t)(p - buf) + 1U);
+            }
+            else if (b == QS_ESC) {
+                me->esc = 1U;
+            }
+            else {
+                if (me->esc != 0U) {
+                    b ^= QS_ESC_XOR;
+                    me->esc = 0U;
+                }
+                if (me->hdr == 1U) {
+                    me->rec = b;
+                }
+                ++me->hdr;
+            }
+            ++p;
+        }
+        else {
+            p = (uint8_t const *)memchr(p, QS_FRAME, (size_t)(end - p));
+            if (p == (uint8_t const *)0) {
+                break;
+            }
+            QSpyFlightRec_frameEnd(me, base + (uint64_t)(p - buf) + 1U);
+            ++p;
+        }
+    }
+}
+//............................................................................
+QSpyStatus QSpyFlightRec_poll(QSpyFlightRec * const me) {
+    return (me->pending != 0U)
+           ? QSpyFlightRec_dump(me)
+           : QSPY_SUCCESS;
+}
+
+//............................................................................
+static void QSpyFlightRec_onLines(QSpyBatchLine const *lines,
+                                  uint32_t nLines, void *arg)
+{
+    FILE *f = (FILE *)arg;
+    for (uint32_t i = 0U; i < nLines; ++i) {
+        FPRINTF_S(f, "%s\n", lines[i].line);
+    }
+}
+//............................................................................
+QSpyStatus QSpyFlightRec_dump(QSpyFlightRec * const me) {
+    me->pending = 0U; // all the triggers so far go into this dump
+
+    // time-stamped name of the dump
+    time_t now = time((time_t *)0);
+    struct tm tstamp;
+    LOCALTIME_S(&tstamp, &now);
+    char base[QSPY_FLIGHT_FNAME_LEN];
+    SNPRINTF_S(base, sizeof(base), "%s%02d%02d%02d_%02d%02d%02d",
+               me->prefix,
+               (tstamp.tm_year + 1900) % 100,
+               (tstamp.tm_mon + 1),
+               tstamp.tm_mday,
+               tstamp.tm_hour,
+               tstamp.tm_min,
+               tstamp.tm_sec);
+    size_t len = strlen(base);
+    if ((me->nDumps > 0U)
+        && (strncmp(me->fName, base, len) == 0)
+        && (me->fName[len] == '.' || me->fName[len] == '_'))
+    {
+        // another dump within the same second
+        SNPRINTF_S(&base[len], sizeof(base) - len, "_%u",
+                   (unsigned)me->nDumps);
+    }
+    ++me->nDumps;
+
+    char fName[QSPY_FLIGHT_FNAME_LEN + 4];
+    SNPRINTF_S(fName, sizeof(fName), "%s.bin", base);
+    FILE *f;
+    FOPEN_S(f, fName, "wb");
+    if (f == (FILE *)0) {
+        return QSPY_ERROR;
+    }
+    string_copy(me->fName, sizeof(me->fName), fName);
+
+    // the content of the ring (oldest first)
+    uint8_t const *p1 = me->ring;
+    size_t n1 = (size_t)me->total;
+    uint8_t const *p2 = me->ring;
+    size_t n2 = 0U;
+    if (me->total > me->size) { // wrapped around?
+        size_t at = (size_t)(me->total % me->size);
+        p1 = &me->ring[at];
+        n1 = me->size - at;
+        n2 = at;
+
+        // skip the (partially overwritten) oldest frame
+        uint8_t const *q = (uint8_t const *)memchr(p1, QS_FRAME, n1);
+        if (q != (uint8_t const *)0) {
+            n1 -= (size_t)(q + 1 - p1);
+            p1 = q + 1;
+        }
+        else {
+            n1 = 0U;
+            q = (uint8_t const *)memchr(p2, QS_FRAME, n2);
+            if (q != (uint8_t const *)0) {
+                n2 -= (size_t)(q + 1 - p2);
+                p2 = q + 1;
+            }
+        }
+    }
+    bool ok = (fwrite(me->sticky, 1U, me->stickyLen, f) == me->stickyLen)
+              && (fwrite(p1, 1U, n1, f) == n1)
+              && (fwrite(p2, 1U, n2, f) == n2);
+    fclose(f);
+    if (!ok) {
+        return QSPY_ERROR;
+    }
+
+    // decode the dump into the .txt file
+    char txtName[QSPY_FLIGHT_FNAME_LEN + 4];
+    SNPRINTF_S(txtName, sizeof(txtName), "%s.txt", base);
+    FOPEN_S(f, txtName, "w");
+    if (f == (FILE *)0) {
+        return QSPY_ERROR;
+    }
+    QSpyStatus status = QENG_decodeFile(fName, 1U, &QSPY_conf,
+                                        QSPY_currParser->custParseFun,
+                                        &QSpyFlightRec_onLines, f);
+    fclose(f);
+    return status;
+}
@@ -38,27 +38,25 @@ typedef uint32_t QPSet;   // dummy definition for including "qpc_qs.h"
 #include "qspy.h"       // QSPY data parser
 #include "pal.h"        // Platform Abstraction Layer
 
-// global objects ............................................................
-QSPY_LastOutput QSPY_output;
-char const * const QSPY_line = &QSPY_output.buf[QS_LINE_OFFSET];
-
-QSpyConfig    QSPY_conf;
-Dictionary    QSPY_funDict;
-Dictionary    QSPY_objDict;
-Dictionary    QSPY_usrDict;
-SigDictionary QSPY_sigDict;
-Dictionary    QSPY_enumDict[8];
+// SIMD support for the bulk path in QSPY_parse()
+// NOTE: define QSPY_NO_SIMD to build only the scalar (reference) path
+#ifndef QSPY_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>  // SSE2 intrinsics
+#define QSPY_SIMD_SSE2
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#include <arm_neon.h>   // NEON intrinsics
+#define QSPY_SIMD_NEON
+#endif
+#endif // QSPY_NO_SIMD
 
-//============================================================================
-static DictEntry     l_funSto[8192];
-static DictEntry     l_objSto[2048];
-static DictEntry     l_usrSto[128 + 1 - QS_USER];
-static SigDictEntry  l_sigSto[8192];
-static DictEntry     l_enumSto[8][256];
+// global objects ............................................................
+QSpyParser QSPY_parser;
+QSPY_THREAD_LOCAL QSpyParser *QSPY_currParser = &QSPY_parser;
 
 //............................................................................
 static FILE         *l_matFile;
-static QSPY_CustParseFun l_custParseFun;
 static QSPY_resetFun     l_txResetFun;
 
 typedef struct {
@@ -240,12 +238,16 @@ static char const *  l_qs_rx_rec[] = {
     "QS_RX_EVENT"
 };
 
+// the host-application facilities (Tx-reset, Matlab and Sequence output,
+// external dictionaries) are attached only to the default parser
+#define QSPY_IS_HOST() (QSPY_currParser == &QSPY_parser)
+
 // facilities for QSPY host application only (but not for QSPY parser)
 #ifdef QSPY_APP
 
-#define FPRINF_MATFILE(format_, ...)                \
-    if (l_matFile != (FILE *)0) {                   \
-        FPRINTF_S(l_matFile, format_, __VA_ARGS__); \
+#define FPRINF_MATFILE(format_, ...)                        \
+    if ((l_matFile != (FILE *)0) && QSPY_IS_HOST()) {       \
+        FPRINTF_S(l_matFile, format_, __VA_ARGS__);         \
     } else (void)0
 
 #else
@@ -258,42 +260,31 @@ static char const *  l_qs_rx_rec[] = {
 void QSPY_config(QSpyConfig const *config,
                  QSPY_CustParseFun custParseFun)
 {
-    QSPY_conf = *config; // copy over
-
-    l_custParseFun = custParseFun;
-
-    Dictionary_ctor(&QSPY_funDict, l_funSto,
-                    sizeof(l_funSto)/sizeof(l_funSto[0]));
-    Dictionary_config(&QSPY_funDict, QSPY_conf.funPtrSize);
-
-    Dictionary_ctor(&QSPY_objDict, l_objSto,
-                    sizeof(l_objSto)/sizeof(l_objSto[0]));
-    Dictionary_config(&QSPY_objDict, QSPY_conf.objPtrSize);
-
-    Dictionary_ctor(&QSPY_usrDict, l_usrSto,
-                    sizeof(l_usrSto)/sizeof(l_usrSto[0]));
-    Dictionary_config(&QSPY_usrDict, 1);
-
-    SigDictionary_ctor(&QSPY_sigDict, l_sigSto,
-                       sizeof(l_sigSto)/sizeof(l_sigSto[0]));
-    SigDictionary_config(&QSPY_sigDict, QSPY_conf.objPtrSize);
-
-    for (unsigned i = 0U;
-         i < sizeof(QSPY_enumDict)/sizeof(QSPY_enumDict[0]);
-         ++i)
-    {
-        Dictionary_ctor(&QSPY_enumDict[i], l_enumSto[i],
-                        sizeof(l_enumSto[i])/sizeof(l_enumSto[i][0]));
-        Dictionary_config(&QSPY_enumDict[i], 1);
-    }
-
-    QSPY_conf.qpDate = 0U; // invalidate the date to indicate "no-target-info"
+    QSpyParser_xtor(QSPY_currParser); // release the previous tables, if any
+    QSpyParser_init(QSPY_currParser, config, custParseFun);
 }
 //............................................................................
 void QSPY_configTxReset(QSPY_resetFun txResetFun) {
     l_txResetFun = txResetFun;
 }
 //............................................................................
+void QSPY_configText(bool enable) {
+    QSPY_currParser->textOn = enable;
+}
+//............................................................................
+void QSPY_configOnRecord(QSPY_RecordFun onRecordFun) {
+    QSPY_currParser->onRecordFun = onRecordFun;
+}
+//............................................................................
+void QSPY_configClockFit(bool enable) {
+    QSPY_currParser->clock.fitOn = enable;
+    QSPY_currParser->clock.nSamples = 0U; // restart the fit
+}
+//............................................................................
+QSpyStatus QSPY_configRecordSize(uint32_t size) {
+    return QSpyParser_configRecordSize(QSPY_currParser, size);
+}
+//............................................................................
 void QSPY_configMatFile(void *matFile) {
     if (l_matFile != (FILE *)0) {
         fclose(l_matFile);
@@ -314,6 +305,27 @@ void QSpyRecord_init(QSpyRecord * const me,
     // set the current QS record-ID for any subsequent output
     QSPY_output.rec  = me->rec;
     QSPY_output.rx_status = -1;
+
+    // start the typed decoding of the record
+    QSpyRecData * const data = &QSPY_currParser->recData;
+    data->rec       = me->rec;
+    data->seq       = start[0];
+    data->hasTstamp = false;
+    data->nFld      = 0U;
+}
+//............................................................................
+// log the field just decoded into the typed record
+static QSpyField *QSpyRecord_logFld(uint8_t type, uint8_t size) {
+    QSpyRecData * const data = &QSPY_currParser->recData;
+    if (data->nFld < QSPY_REC_FIELDS_MAX) {
+        QSpyField *fld = &data->fld[data->nFld];
+        ++data->nFld;
+        fld->type = type;
+        fld->size = size;
+        fld->num  = 1U;
+        return fld;
+    }
+    return (QSpyField *)0;
 }
 //............................................................................
 QSpyStatus QSpyRecord_OK(QSpyRecord * const me) {
@@ -333,7 +345,7 @@ QSpyStatus QSpyRecord_OK(QSpyRecord * const me) {
         else { // application-specific (user) record
             SNPRINTF_APPEND("Rec=USER+%3d", (int)(me->rec - QS_USER));
         }
-        QSPY_onPrintLn();
+        QSPY_printLn();
         return QSPY_ERROR;
     }
     return QSPY_SUCCESS;
@@ -358,6 +370,10 @@ uint32_t QSpyRecord_getUint32(QSpyRecord * const me, uint8_t size) {
         else {
             Q_ASSERT(0);
         }
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_UINT, size);
+        if (fld != (QSpyField *)0) {
+            fld->val.u = ret;
+        }
         me->pos += size;
         me->len -= size;
     }
@@ -365,7 +381,7 @@ uint32_t QSpyRecord_getUint32(QSpyRecord * const me, uint8_t size) {
         SNPRINTF_LINE("   <COMMS> ERROR    %d more bytes needed for uint%d_t ",
                      (int)(size - me->len), (int)(size*8U));
         me->len = -1;
-        QSPY_onPrintLn();
+        QSPY_printLn();
     }
     return ret;
 }
@@ -394,6 +410,10 @@ int32_t QSpyRecord_getInt32(QSpyRecord * const me, uint8_t size) {
         else {
             Q_ASSERT(0);
         }
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_INT, size);
+        if (fld != (QSpyField *)0) {
+            fld->val.i = ret;
+        }
         me->pos += size;
         me->len -= size;
     }
@@ -401,7 +421,7 @@ int32_t QSpyRecord_getInt32(QSpyRecord * const me, uint8_t size) {
         SNPRINTF_LINE("   <COMMS> ERROR    %d more bytes needed for int%d_t ",
                      (int)(size - me->len), (int)(size*8U));
         me->len = -1;
-        QSPY_onPrintLn();
+        QSPY_printLn();
     }
     return ret;
 }
@@ -436,6 +456,10 @@ uint64_t QSpyRecord_getUint64(QSpyRecord * const me, uint8_t size) {
         else {
             Q_ASSERT(0);
         }
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_UINT, size);
+        if (fld != (QSpyField *)0) {
+            fld->val.u = ret;
+        }
         me->pos += size;
         me->len -= size;
     }
@@ -443,7 +467,7 @@ uint64_t QSpyRecord_getUint64(QSpyRecord * const me, uint8_t size) {
         SNPRINTF_LINE("   <COMMS> ERROR    %d more bytes needed for uint%d_t ",
                      (int)(size - me->len), (int)(size*8U));
         me->len = -1;
-        QSPY_onPrintLn();
+        QSPY_printLn();
     }
     return ret;
 }
@@ -484,6 +508,10 @@ int64_t QSpyRecord_getInt64(QSpyRecord * const me, uint8_t size) {
         else {
             Q_ASSERT(0);
         }
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_INT, size);
+        if (fld != (QSpyField *)0) {
+            fld->val.i = ret;
+        }
         me->pos += size;
         me->len -= size;
     }
@@ -491,7 +519,7 @@ int64_t QSpyRecord_getInt64(QSpyRecord * const me, uint8_t size) {
         SNPRINTF_LINE("   <COMMS> ERROR    %d more bytes needed for int%d_t ",
                      (int)(size - me->len), (int)(size*8U));
         me->len = -1;
-        QSPY_onPrintLn();
+        QSPY_printLn();
     }
     return ret;
 }
@@ -506,6 +534,11 @@ char const *QSpyRecord_getStr(QSpyRecord * const me) {
         --me->len;
         ++me->pos;
 
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_STR, 1U);
+        if (fld != (QSpyField *)0) {
+            fld->val.str = "";
+        }
+
         // return explicit empty string as two single-quotes ''
         return "''";
     }
@@ -514,6 +547,11 @@ char const *QSpyRecord_getStr(QSpyRecord * const me) {
         if (*p == 0U) { // zero-terminated end of the string?
             char const *s = (char const *)me->pos;
 
+            QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_STR, 1U);
+            if (fld != (QSpyField *)0) {
+                fld->val.str = s;
+            }
+
             // adjust the stream for the next token
             me->len = l - 1;
             me->pos = p + 1;
@@ -525,7 +563,7 @@ char const *QSpyRecord_getStr(QSpyRecord * const me) {
     SNPRINTF_LINE("   <COMMS> ERROR    %d more bytes needed for string",
                  (int)me->len);
     me->len = -1;
-    QSPY_onPrintLn();
+    QSPY_printLn();
     return "";
 }
 //............................................................................
@@ -533,12 +571,21 @@ uint8_t const *QSpyRecord_getMem(QSpyRecord * const me,
                                  uint8_t size,
                                  uint32_t *pNum)
 {
-    if ((me->len >= 1) && ((*me->pos) <= me->len)) {
+    // the whole block (not just the count) must fit in the record
+    if ((me->len >= 1)
+        && ((uint32_t)(*me->pos) * size <= (uint32_t)(me->len - 1)))
+    {
         uint8_t num = *me->pos;
         uint8_t const *mem = me->pos + 1;
         *pNum = num;
         me->len -= 1 + (num * size);
         me->pos += 1 + (num * size);
+
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_MEM, size);
+        if (fld != (QSpyField *)0) {
+            fld->num     = num;
+            fld->val.mem = mem;
+        }
         return mem;
     }
 
@@ -547,11 +594,730 @@ uint8_t const *QSpyRecord_getMem(QSpyRecord * const me,
                  (int)me->len);
     me->len = -1;
     *pNum = 0U;
-    QSPY_onPrintLn();
+    QSPY_printLn();
 
     return (uint8_t *)0;
 }
 
+//............................................................................
+// specialized readers of the little-endian fields (the QS byte order)
+// NOTE: on little-endian hosts the fields are loaded directly
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) \
+    && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+    #define QSPY_HOST_LE 1
+#endif
+
+static uint64_t QSPY_read1(uint8_t const *pos) {
+    return (uint64_t)pos[0];
+}
+static uint64_t QSPY_read2(uint8_t const *pos) {
+#ifdef QSPY_HOST_LE
+    uint16_t v;
+    memcpy(&v, pos, sizeof(v));
+    return (uint64_t)v;
+#else
+    return ((uint64_t)pos[1] << 8) | (uint64_t)pos[0];
+#endif
+}
+static uint64_t QSPY_read4(uint8_t const *pos) {
+#ifdef QSPY_HOST_LE
+    uint32_t v;
+    memcpy(&v, pos, sizeof(v));
+    return (uint64_t)v;
+#else
+    return ((uint64_t)QSPY_read2(&pos[2]) << 16) | QSPY_read2(pos);
+#endif
+}
+static uint64_t QSPY_read8(uint8_t const *pos) {
+#ifdef QSPY_HOST_LE
+    uint64_t v;
+    memcpy(&v, pos, sizeof(v));
+    return v;
+#else
+    return (QSPY_read4(&pos[4]) << 32) | QSPY_read4(pos);
+#endif
+}
+
+//............................................................................
+// get the field whose size comes from the configuration (e.g. QSPY_SZ_OBJ)
+// through the reader selected for the configuration. Fields of sizes the
+// readers don't cover, and the errors, are left to the generic getters.
+static uint64_t QSpyRecord_getCfg64(QSpyRecord * const me, uint8_t src) {
+    QSpyParser const * const p = QSPY_currParser;
+    uint8_t const size = p->readSize[src];
+    if ((p->readFun[src] != (QSPY_ReadFun)0) && (me->len >= size)) {
+        uint64_t ret = (*p->readFun[src])(me->pos);
+        QSpyField *fld = QSpyRecord_logFld(QSPY_FLD_UINT, size);
+        if (fld != (QSpyField *)0) {
+            fld->val.u = ret;
+        }
+        me->pos += size;
+        me->len -= size;
+        return ret;
+    }
+    return ((src == QSPY_SZ_OBJ) || (src == QSPY_SZ_FUN))
+           ? QSpyRecord_getUint64(me, size)
+           : (uint64_t)QSpyRecord_getUint32(me, size);
+}
+//............................................................................
+static uint32_t QSpyRecord_getCfg32(QSpyRecord * const me, uint8_t src) {
+    return (uint32_t)QSpyRecord_getCfg64(me, src);
+}
+
+//============================================================================
+// target clock...
+
+// host wall-clock time [ns since 1970]
+static uint64_t QSPY_nowNs(void) {
+    struct timespec ts;
+    if (timespec_get(&ts, TIME_UTC) == 0) {
+        return 0U;
+    }
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+//............................................................................
+// restart the unwrapping after a target reset (the timestamps continue
+// after the last one) and restart the fit, if any
+static void QSpyClock_restart(QSpyClock * const me) {
+    if (me->valid) {
+        me->epoch = me->last64 + 1U;
+        me->valid = false;
+    }
+    me->sample   = false;
+    me->nSamples = 0U;
+}
+//............................................................................
+static uint64_t QSpyClock_unwrap(QSpyClock * const me,
+                                 uint32_t t, uint8_t size)
+{
+    if (!me->valid) {
+        me->valid  = true;
+        me->last   = t;
+        me->last64 = me->epoch + t;
+        return me->last64;
+    }
+    uint32_t const mask = (size < 4U)
+                          ? ((1U << (8U * size)) - 1U)
+                          : 0xFFFFFFFFU;
+    uint32_t const delta = (t - me->last) & mask;
+    if (delta > (mask >> 1U)) { // a step back (not a wrap-around)?
+        uint32_t const back = (me->last - t) & mask;
+        return (me->last64 > back) ? (me->last64 - back) : 0U;
+    }
+    me->last    = t;
+    me->last64 += delta;
+    return me->last64;
+}
+//............................................................................
+// add the sample (the last timestamp, host time) to the fit
+static void QSpyClock_sample(QSpyClock * const me, uint64_t hostNs) {
+    me->sample = false;
+    if (me->nSamples == 0U) { // the first sample?
+        me->x0  = me->last64;
+        me->y0  = hostNs;
+        me->w   = 0.0;
+        me->mx  = 0.0;
+        me->my  = 0.0;
+        me->cxx = 0.0;
+        me->cxy = 0.0;
+    }
+    double const x = (double)(int64_t)(me->last64 - me->x0);
+    double const y = (double)(int64_t)(hostNs - me->y0);
+
+    // exponentially weighted (Welford) update of the means and co-moments
+    double const lambda = 1.0 - (1.0 / QSPY_CLOCK_FIT_WINDOW);
+    me->w = (lambda * me->w) + 1.0;
+    double const dx = x - me->mx;
+    double const dy = y - me->my;
+    me->mx += dx / me->w;
+    me->my += dy / me->w;
+    me->cxx = (lambda * me->cxx) + (dx * (x - me->mx));
+    me->cxy = (lambda * me->cxy) + (dx * (y - me->my));
+    ++me->nSamples;
+
+    if (me->cxx > 0.0) {
+        me->b = me->cxy / me->cxx;
+        me->a = me->my - (me->b * me->mx);
+    }
+    else {
+        me->nSamples = 1U; // no spread of the target time yet
+    }
+}
+//............................................................................
+// stamp the record being decoded with the timestamp
+static void QSpyParser_stamp(QSpyParser * const me, uint32_t t) {
+    QSpyRecData * const data = &me->recData;
+    data->hasTstamp = true;
+    data->tstamp    = t;
+    data->tstamp64  = QSpyClock_unwrap(&me->clock, t, me->conf.tstampSize);
+    data->wallNs    = 0U;
+    if (me->clock.fitOn) {
+        me->clock.sample = true;
+        if (me->clock.nSamples > 1U) {
+            double const x = (double)(int64_t)(data->tstamp64
+                                               - me->clock.x0);
+            data->wallNs = me->clock.y0
+                + (uint64_t)(int64_t)(me->clock.a + (me->clock.b * x));
+        }
+    }
+}
+
+//............................................................................
+// get the timestamp and record it in the typed record
+static uint32_t QSpyRecord_getTstamp(QSpyRecord * const me) {
+    uint32_t t = QSpyRecord_getCfg32(me, QSPY_SZ_TSTAMP);
+    QSpyParser_stamp(QSPY_currParser, t);
+    return t;
+}
+
+//============================================================================
+// table-driven decoding of the predefined QS records...
+// NOTE: the schemas must list the fields exactly as QSpyRecord_process()
+// reads them.
+
+#define SCH_TS   { QSPY_SZ_TSTAMP, QSPY_DICT_NONE }
+#define SCH_OBJ  { QSPY_SZ_OBJ,    QSPY_DICT_OBJ  }
+#define SCH_FUN  { QSPY_SZ_FUN,    QSPY_DICT_FUN  }
+#define SCH_SIG  { QSPY_SZ_SIG,    QSPY_DICT_SIG  }
+#define SCH_EVT  { QSPY_SZ_EVT,    QSPY_DICT_NONE }
+#define SCH_QCTR { QSPY_SZ_QCTR,   QSPY_DICT_NONE }
+#define SCH_PCTR { QSPY_SZ_PCTR,   QSPY_DICT_NONE }
+#define SCH_TCTR { QSPY_SZ_TCTR,   QSPY_DICT_NONE }
+#define SCH_U8   { QSPY_SZ_U8,     QSPY_DICT_NONE }
+#define SCH_U16  { QSPY_SZ_U16,    QSPY_DICT_NONE }
+#define SCH_U32  { QSPY_SZ_U32,    QSPY_DICT_NONE }
+#define SCH_STR  { QSPY_SZ_STR,    QSPY_DICT_NONE }
+
+static QSpyRecSchema const l_recSchema[QSPY_SCHEMA_RECS] = {
+    // QEP records
+    [QS_QEP_STATE_ENTRY]   = { 2, { SCH_OBJ, SCH_FUN } },
+    [QS_QEP_STATE_EXIT]    = { 2, { SCH_OBJ, SCH_FUN } },
+    [QS_QEP_STATE_INIT]    = { 3, { SCH_OBJ, SCH_FUN, SCH_FUN } },
+    [QS_QEP_INIT_TRAN]     = { 3, { SCH_TS, SCH_OBJ, SCH_FUN } },
+    [QS_QEP_INTERN_TRAN]   = { 4, { SCH_TS, SCH_SIG, SCH_OBJ, SCH_FUN } },
+    [QS_QEP_TRAN]          = { 5, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_FUN, SCH_FUN } },
+    [QS_QEP_IGNORED]       = { 4, { SCH_TS, SCH_SIG, SCH_OBJ, SCH_FUN } },
+    [QS_QEP_DISPATCH]      = { 4, { SCH_TS, SCH_SIG, SCH_OBJ, SCH_FUN } },
+    [QS_QEP_UNHANDLED]     = { 3, { SCH_SIG, SCH_OBJ, SCH_FUN } },
+    [QS_QEP_TRAN_HIST]     = { 3, { SCH_OBJ, SCH_FUN, SCH_FUN } },
+    [QS_RESERVED_56]       = { 3, { SCH_OBJ, SCH_FUN, SCH_FUN } },
+    [QS_RESERVED_57]       = { 3, { SCH_OBJ, SCH_FUN, SCH_FUN } },
+
+    // QF records
+    [QS_QF_ACTIVE_DEFER]   = { 6, { SCH_TS, SCH_OBJ, SCH_OBJ, SCH_SIG,
+                                    SCH_U8, SCH_U8 } },
+    [QS_QF_ACTIVE_DEFER_ATTEMPT] = { 6, { SCH_TS, SCH_OBJ, SCH_OBJ, SCH_SIG,
+                                    SCH_U8, SCH_U8 } },
+    [QS_QF_ACTIVE_RECALL]  = { 6, { SCH_TS, SCH_OBJ, SCH_OBJ, SCH_SIG,
+                                    SCH_U8, SCH_U8 } },
+    [QS_QF_ACTIVE_RECALL_ATTEMPT] = { 3, { SCH_TS, SCH_OBJ, SCH_OBJ } },
+    [QS_QF_ACTIVE_SUBSCRIBE]   = { 3, { SCH_TS, SCH_SIG, SCH_OBJ } },
+    [QS_QF_ACTIVE_UNSUBSCRIBE] = { 3, { SCH_TS, SCH_SIG, SCH_OBJ } },
+    [QS_QF_ACTIVE_POST]    = { 8, { SCH_TS, SCH_OBJ, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR, SCH_QCTR } },
+    [QS_QF_ACTIVE_POST_ATTEMPT] = { 8, { SCH_TS, SCH_OBJ, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR, SCH_QCTR } },
+    [QS_QF_ACTIVE_POST_LIFO] = { 7, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR, SCH_QCTR } },
+    [QS_QF_ACTIVE_GET]     = { 6, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR } },
+    [QS_QF_ACTIVE_GET_LAST] = { 5, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8 } },
+    [QS_QF_EQUEUE_POST]    = { 7, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR, SCH_QCTR } },
+    [QS_QF_EQUEUE_POST_ATTEMPT] = { 7, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR, SCH_QCTR } },
+    [QS_QF_EQUEUE_POST_LIFO] = { 7, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR, SCH_QCTR } },
+    [QS_QF_EQUEUE_GET]     = { 6, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8, SCH_QCTR } },
+    [QS_QF_EQUEUE_GET_LAST] = { 5, { SCH_TS, SCH_SIG, SCH_OBJ,
+                                    SCH_U8, SCH_U8 } },
+    [QS_QF_MPOOL_GET]      = { 4, { SCH_TS, SCH_OBJ, SCH_PCTR, SCH_PCTR } },
+    [QS_QF_MPOOL_GET_ATTEMPT] = { 4, { SCH_TS, SCH_OBJ,
+                                    SCH_PCTR, SCH_PCTR } },
+    [QS_QF_MPOOL_PUT]      = { 3, { SCH_TS, SCH_OBJ, SCH_PCTR } },
+    [QS_QF_NEW]            = { 3, { SCH_TS, SCH_EVT, SCH_SIG } },
+    [QS_QF_NEW_ATTEMPT]    = { 3, { SCH_TS, SCH_EVT, SCH_SIG } },
+    [QS_QF_PUBLISH]        = { 5, { SCH_TS, SCH_OBJ, SCH_SIG,
+                                    SCH_U8, SCH_U8 } },
+    [QS_QF_NEW_REF]        = { 4, { SCH_TS, SCH_SIG, SCH_U8, SCH_U8 } },
+    [QS_QF_DELETE_REF]     = { 4, { SCH_TS, SCH_SIG, SCH_U8, SCH_U8 } },
+    [QS_QF_GC]             = { 4, { SCH_TS, SCH_SIG, SCH_U8, SCH_U8 } },
+    [QS_QF_GC_ATTEMPT]     = { 4, { SCH_TS, SCH_SIG, SCH_U8, SCH_U8 } },
+    [QS_QF_TICK]           = { 2, { SCH_TCTR, SCH_U8 } },
+    [QS_QF_TIMEEVT_ARM]    = { 6, { SCH_TS, SCH_OBJ, SCH_OBJ,
+                                    SCH_TCTR, SCH_TCTR, SCH_U8 } },
+    [QS_QF_TIMEEVT_DISARM] = { 6, { SCH_TS, SCH_OBJ, SCH_OBJ,
+                                    SCH_TCTR, SCH_TCTR, SCH_U8 } },
+    [QS_QF_TIMEEVT_AUTO_DISARM] = { 3, { SCH_OBJ, SCH_OBJ, SCH_U8 } },
+    [QS_QF_TIMEEVT_DISARM_ATTEMPT] = { 4, { SCH_TS, SCH_OBJ, SCH_OBJ,
+                                    SCH_U8 } },
+    [QS_QF_TIMEEVT_REARM]  = { 7, { SCH_TS, SCH_OBJ, SCH_OBJ,
+                                    SCH_TCTR, SCH_TCTR, SCH_U8, SCH_U8 } },
+    [QS_QF_TIMEEVT_POST]   = { 5, { SCH_TS, SCH_OBJ, SCH_SIG, SCH_OBJ,
+                                    SCH_U8 } },
+    [QS_QF_CRIT_ENTRY]     = { 2, { SCH_TS, SCH_U8 } },
+    [QS_QF_CRIT_EXIT]      = { 2, { SCH_TS, SCH_U8 } },
+    [QS_QF_ISR_ENTRY]      = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_QF_ISR_EXIT]       = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_QF_INT_DISABLE]    = { 2, { SCH_TS, SCH_U8 } },
+    [QS_QF_INT_ENABLE]     = { 2, { SCH_TS, SCH_U8 } },
+
+    // scheduler records
+    [QS_SCHED_PREEMPT]     = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_SCHED_RESTORE]     = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_SCHED_LOCK]        = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_SCHED_UNLOCK]      = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_SCHED_NEXT]        = { 3, { SCH_TS, SCH_U8, SCH_U8 } },
+    [QS_SCHED_IDLE]        = { 2, { SCH_TS, SCH_U8 } },
+
+    // test and error records
+    [QS_TEST_PROBE_GET]    = { 3, { SCH_TS, SCH_FUN, SCH_U32 } },
+    [QS_ASSERT_FAIL]       = { 3, { SCH_TS, SCH_U16, SCH_STR } },
+
+    // semaphore and mutex records
+    [QS_SEM_TAKE]          = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_SEM_BLOCK]         = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_SEM_SIGNAL]        = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_SEM_BLOCK_ATTEMPT] = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_MTX_LOCK]          = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_MTX_UNLOCK]        = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_MTX_LOCK_ATTEMPT]  = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_MTX_UNLOCK_ATTEMPT] = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_MTX_BLOCK]         = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+    [QS_MTX_BLOCK_ATTEMPT] = { 4, { SCH_TS, SCH_OBJ, SCH_U8, SCH_U8 } },
+};
+
+//............................................................................
+QSpyRecSchema const *QSPY_getRecSchema(uint8_t rec) {
+    if ((rec < QSPY_SCHEMA_RECS) && (l_recSchema[rec].nFld != 0U)) {
+        return &l_recSchema[rec];
+    }
+    return (QSpyRecSchema const *)0;
+}
+//............................................................................
+void QSpyParser_updateLayout(QSpyParser * const me) {
+    uint8_t sz[QSPY_SZ_STR + 1];
+    sz[QSPY_SZ_NONE]   = 0U;
+    sz[QSPY_SZ_TSTAMP] = me->conf.tstampSize;
+    sz[QSPY_SZ_OBJ]    = me->conf.objPtrSize;
+    sz[QSPY_SZ_FUN]    = me->conf.funPtrSize;
+    sz[QSPY_SZ_SIG]    = me->conf.sigSize;
+    sz[QSPY_SZ_EVT]    = me->conf.evtSize;
+    sz[QSPY_SZ_QCTR]   = me->conf.queueCtrSize;
+    sz[QSPY_SZ_PCTR]   = me->conf.poolCtrSize;
+    sz[QSPY_SZ_TCTR]   = me->conf.tevtCtrSize;
+    sz[QSPY_SZ_U8]     = 1U;
+    sz[QSPY_SZ_U16]    = 2U;
+    sz[QSPY_SZ_U32]    = 4U;
+    sz[QSPY_SZ_STR]    = 0U;
+
+    // select the readers for the sizes of this configuration
+    // (only the sizes the QSpyRecord_get*() facilities accept)
+    for (uint8_t src = 0U; src < QSPY_SZ_STR; ++src) {
+        QSPY_ReadFun read;
+        switch (sz[src]) {
+            case 1U: read = &QSPY_read1; break;
+            case 2U: read = &QSPY_read2; break;
+            case 4U: read = &QSPY_read4; break;
+            case 8U:
+                read = ((src == QSPY_SZ_OBJ) || (src == QSPY_SZ_FUN))
+                       ? &QSPY_read8
+                       : (QSPY_ReadFun)0;
+                break;
+            default: read = (QSPY_ReadFun)0; break;
+        }
+        me->readFun[src]  = read;
+        me->readSize[src] = sz[src];
+    }
+
+    // the plans of the user records depend on the sizes as well
+    for (unsigned i = 0U; i < QSPY_USR_RECS; ++i) {
+        me->usrPlan[i].len = 0U;
+    }
+
+    for (unsigned rec = 0U; rec < QSPY_SCHEMA_RECS; ++rec) {
+        QSpyRecSchema const * const sch = &l_recSchema[rec];
+        QSpyRecLayout * const lay = &me->layout[rec];
+        bool fixed = (sch->nFld != 0U);
+        uint32_t offs = 0U;
+        for (uint8_t i = 0U; i < sch->nFld; ++i) {
+            uint8_t src  = sch->fld[i].size;
+            uint8_t size = sz[src];
+            if ((src == QSPY_SZ_STR)
+                || (me->readFun[src] == (QSPY_ReadFun)0))
+            {
+                fixed = false; // the record is decoded field by field
+            }
+            lay->offs[i] = (uint8_t)offs;
+            lay->size[i] = size;
+            offs += size;
+        }
+        lay->len = fixed ? (uint8_t)offs : 0U;
+    }
+}
+//............................................................................
+// decode the predefined record with a schema into the typed record
+// without rendering any text, returns false for records without a schema
+static bool QSpyRecord_decode(QSpyRecord * const me) {
+    QSpyRecSchema const * const sch = &l_recSchema[me->rec];
+    if (sch->nFld == 0U) {
+        return false;
+    }
+    QSpyRecLayout const * const lay = &QSPY_currParser->layout[me->rec];
+    if ((lay->len != 0U) && (me->len == (int32_t)lay->len)) {
+        // fixed-size record of the expected length: straight-line decode
+        QSpyParser const * const p = QSPY_currParser;
+        QSpyRecData * const data = &QSPY_currParser->recData;
+        uint8_t const * const pos = me->pos;
+        for (uint8_t i = 0U; i < sch->nFld; ++i) {
+            uint64_t u = (*p->readFun[sch->fld[i].size])(&pos[lay->offs[i]]);
+            QSpyField * const fld = &data->fld[i];
+            fld->type  = QSPY_FLD_UINT;
+            fld->size  = lay->size[i];
+            fld->num   = 1U;
+            fld->val.u = u;
+            if (sch->fld[i].size == QSPY_SZ_TSTAMP) {
+                QSpyParser_stamp(QSPY_currParser, (uint32_t)u);
+            }
+        }
+        data->nFld = sch->nFld;
+        me->pos += lay->len;
+        me->len  = 0;
+    }
+    else { // variable-size or malformed record: field by field
+        for (uint8_t i = 0U; i < sch->nFld; ++i) {
+            switch (sch->fld[i].size) {
+                case QSPY_SZ_TSTAMP:
+                    (void)QSpyRecord_getTstamp(me);
+                    break;
+                case QSPY_SZ_STR:
+                    (void)QSpyRecord_getStr(me);
+                    break;
+                case QSPY_SZ_U8:
+                    (void)QSpyRecord_getUint32(me, 1U);
+                    break;
+                case QSPY_SZ_U16:
+                    (void)QSpyRecord_getUint32(me, 2U);
+                    break;
+                case QSPY_SZ_U32:
+                    (void)QSpyRecord_getUint32(me, 4U);
+                    break;
+                default:
+                    (void)QSpyRecord_getCfg64(me, sch->fld[i].size);
+                    break;
+            }
+        }
+    }
+    return true;
+}
+//............................................................................
+// can the records be decoded without QSpyRecord_process()? This is the
+// case when no output depends on the records (no text, Matlab or Sequence)
+static bool QSPY_isHeadless(void) {
+    if (QSPY_TEXT_ON()) {
+        return false;
+    }
+#ifdef QSPY_APP
+    if (QSPY_IS_HOST() && ((l_matFile != (FILE *)0) || QSEQ_isActive())) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+//============================================================================
+// fast formatting of the QSPY output line...
+// NOTE: the following facilities append to the QSPY line exactly
+// the same characters as SNPRINTF_APPEND() with the equivalent printf()
+// format, but without parsing the format at run-time.
+
+static char const l_hexDigits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// pairs of decimal digits "00".."99"
+static char const l_decPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+enum {
+    QSPY_FMT_WIDTH_MAX = 32, // max field width of the fast formatters
+};
+
+//............................................................................
+// append n characters (same as SNPRINTF_APPEND("%s", str) for n==strlen)
+static void QSPY_appendStr(char const *str, int n) {
+    if (QSPY_TEXT_ON()) {
+        int room = QS_LINE_LEN_MAX - QS_LINE_OFFSET - QSPY_output.len;
+        char *dst = &QSPY_output.buf[QS_LINE_OFFSET + QSPY_output.len];
+        if ((0 < n) && (n < room)) {
+            memcpy(dst, str, (size_t)n);
+            dst[n] = '\0';
+            QSPY_output.len += n;
+        }
+        else { // empty or truncated output, see SNPRINTF_APPEND()
+            if (room > 0) {
+                int m = (n < room) ? n : (room - 1);
+                memcpy(dst, str, (size_t)m);
+                dst[m] = '\0';
+            }
+            QSPY_output.len = QS_LINE_LEN_MAX - QS_LINE_OFFSET;
+        }
+    }
+}
+//............................................................................
+// append the decimal number (same as "%<width>llu"/"%<width>lld" for the
+// pad ' ', and as "%0<width>llu" for the pad '0')
+static void QSPY_appendDec(uint64_t u, bool neg, unsigned width, char pad) {
+    char buf[QSPY_FMT_WIDTH_MAX + 24];
+    char *end = &buf[sizeof(buf)];
+    char *p = end;
+    while (u >= 100U) { // two digits at a time
+        unsigned r = (unsigned)(u % 100U);
+        u /= 100U;
+        p -= 2;
+        p[0] = l_decPairs[2U*r];
+        p[1] = l_decPairs[2U*r + 1U];
+    }
+    if (u >= 10U) {
+        p -= 2;
+        p[0] = l_decPairs[2U*u];
+        p[1] = l_decPairs[2U*u + 1U];
+    }
+    else {
+        *--p = (char)('0' + u);
+    }
+    Q_ASSERT(width <= QSPY_FMT_WIDTH_MAX);
+    unsigned len = (unsigned)(end - p) + (neg ? 1U : 0U);
+    if (pad == '0') { // zeros go between the sign and the digits
+        for (; len < width; ++len) {
+            *--p = '0';
+        }
+    }
+    if (neg) {
+        *--p = '-';
+    }
+    for (; len < width; ++len) { // spaces go in front of the sign
+        *--p = ' ';
+    }
+    QSPY_appendStr(p, (int)(end - p));
+}
+//............................................................................
+// append the signed decimal number (same as "%<width>lld")
+static void QSPY_appendInt(int64_t i, unsigned width) {
+    if (i < 0) {
+        QSPY_appendDec((uint64_t)0 - (uint64_t)i, true, width, ' ');
+    }
+    else {
+        QSPY_appendDec((uint64_t)i, false, width, ' ');
+    }
+}
+//............................................................................
+// append the hex number with upper-case digits (same as "%0<width>llX"
+// for the pad '0' and as "%<width>llX" for the pad ' ')
+static void QSPY_appendHex(uint64_t u, unsigned width, char pad) {
+    char buf[QSPY_FMT_WIDTH_MAX + 16];
+    char *end = &buf[sizeof(buf)];
+    char *p = end;
+    do { // one nibble at a time
+        *--p = l_hexDigits[u & 0xFU];
+        u >>= 4;
+    } while (u != 0U);
+    Q_ASSERT(width <= QSPY_FMT_WIDTH_MAX);
+    while ((unsigned)(end - p) < width) {
+        *--p = pad;
+    }
+    QSPY_appendStr(p, (int)(end - p));
+}
+//............................................................................
+// append the unsigned number of a user record (same as ufmt[width] or,
+// for the hex format, as uhfmt[hexWidth] in QSpyRecord_processUser())
+static void QSPY_appendUns(uint32_t u, unsigned width,
+                           bool isHex, unsigned hexWidth)
+{
+    if (isHex) {
+        QSPY_appendStr("0x", 2);
+        QSPY_appendHex(u, hexWidth, '0');
+    }
+    else {
+        QSPY_appendDec(u, false, width, ' ');
+    }
+}
+//............................................................................
+// append the memory dump (same as SNPRINTF_APPEND(" %02X") for every byte)
+static void QSPY_appendMem(uint8_t const *mem, uint32_t num) {
+    char buf[3*256];
+    while (num > 0U) {
+        uint32_t n = (num < 256U) ? num : 256U;
+        char *p = buf;
+        for (uint32_t k = 0U; k < n; ++k, ++mem, p += 3) {
+            p[0] = ' ';
+            p[1] = l_hexDigits[*mem >> 4];
+            p[2] = l_hexDigits[*mem & 0xFU];
+        }
+        QSPY_appendStr(buf, (int)(3U*n));
+        num -= n;
+    }
+}
+
+//============================================================================
+// format-signature plans of the application-specific (user) records...
+
+//............................................................................
+// compile the plan for the user record (positioned after the timestamp),
+// returns false if the record has variable-size elements
+static bool QSpyUsrPlan_compile(QSpyUsrPlan * const me,
+                                QSpyRecord const * const rec)
+{
+    QSpyParser const * const p = QSPY_currParser;
+    uint8_t const * const pos = rec->pos;
+    uint32_t const len = (uint32_t)rec->len;
+    uint32_t offs = 0U;
+    uint8_t  n = 0U;
+
+    me->len = 0U; // invalidate the plan until compiled
+    if ((rec->len <= 0) || (len > 0xFFU)) {
+        return false;
+    }
+    // the fields also go to the typed record after the timestamp
+    uint8_t const nMax = (QSPY_REC_FIELDS_MAX - 1U < QSPY_USR_PLAN_FIELDS)
+                         ? (uint8_t)(QSPY_REC_FIELDS_MAX - 1U)
+                         : (uint8_t)QSPY_USR_PLAN_FIELDS;
+    while (offs < len) {
+        uint8_t const fmt = pos[offs];
+        uint8_t size[2]; // sizes of the element's values (0 for none)
+        uint8_t kind = QSPY_FLD_UINT;
+        size[1] = 0U;
+        switch (fmt & 0x0FU) {
+            case QS_I8_ENUM_FMT:
+                size[0] = 1U;
+                if ((fmt & 0x80U) == 0U) { // QS_I8() (not QS_ENUM())
+                    kind = QSPY_FLD_INT;
+                }
+                break;
+            case QS_U8_FMT:  size[0] = 1U; break;
+            case QS_I16_FMT: size[0] = 2U; kind = QSPY_FLD_INT; break;
+            case QS_U16_FMT: size[0] = 2U; break;
+            case QS_I32_FMT: size[0] = 4U; kind = QSPY_FLD_INT; break;
+            case QS_U32_FMT: size[0] = 4U; break;
+            case QS_F32_FMT: size[0] = 4U; break;
+            case QS_F64_FMT: size[0] = 8U; break;
+            case QS_I64_FMT: size[0] = 8U; kind = QSPY_FLD_INT; break;
+            case QS_U64_FMT: size[0] = 8U; break;
+            case QS_HEX_FMT: size[0] = 4U; break;
+            case QS_SIG_FMT:
+                if ((p->readFun[QSPY_SZ_SIG] == (QSPY_ReadFun)0)
+                    || (p->readFun[QSPY_SZ_OBJ] == (QSPY_ReadFun)0))
+                {
+                    return false;
+                }
+                size[0] = p->readSize[QSPY_SZ_SIG];
+                size[1] = p->readSize[QSPY_SZ_OBJ];
+                break;
+            case QS_OBJ_FMT:
+            case QS_FUN_FMT: {
+                uint8_t src = ((fmt & 0x0FU) == QS_OBJ_FMT)
+                              ? QSPY_SZ_OBJ : QSPY_SZ_FUN;
+                if (p->readFun[src] == (QSPY_ReadFun)0) {
+                    return false;
+                }
+                size[0] = p->readSize[src];
+                break;
+            }
+            default: // QS_STR_FMT, QS_MEM_FMT or unknown
+                return false;
+        }
+        if (n + ((size[1] != 0U) ? 3U : 2U) > nMax) {
+            return false; // too many fields
+        }
+        me->fld[n].offs = (uint8_t)offs;
+        me->fld[n].size = 1U;
+        me->fld[n].kind = QSPY_PLAN_FMT;
+        me->fld[n].fmt  = fmt;
+        ++n;
+        ++offs;
+        for (uint8_t i = 0U; (i < 2U) && (size[i] != 0U); ++i) {
+            if (offs + size[i] > len) {
+                return false; // truncated record
+            }
+            me->fld[n].offs = (uint8_t)offs;
+            me->fld[n].size = size[i];
+            me->fld[n].kind = kind;
+            me->fld[n].fmt  = 0U;
+            ++n;
+            offs += size[i];
+        }
+    }
+    me->nFld = n;
+    me->len  = (uint8_t)len;
+    return true;
+}
+//............................................................................
+// does the user record (positioned after the timestamp) match the plan?
+static bool QSpyUsrPlan_matches(QSpyUsrPlan const * const me,
+                                QSpyRecord const * const rec)
+{
+    if ((me->len == 0U) || (rec->len != (int32_t)me->len)) {
+        return false;
+    }
+    for (uint8_t i = 0U; i < me->nFld; ++i) {
+        if ((me->fld[i].kind == QSPY_PLAN_FMT)
+            && (rec->pos[me->fld[i].offs] != me->fld[i].fmt))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//............................................................................
+// decode the user record (positioned after the timestamp) into the typed
+// record by the plan for its format signature, returns false if the record
+// must be processed by the generic path
+static bool QSpyRecord_decodeUser(QSpyRecord * const me) {
+    static QSPY_ReadFun const readBySize[9] = {
+        (QSPY_ReadFun)0, &QSPY_read1, &QSPY_read2, (QSPY_ReadFun)0,
+        &QSPY_read4, (QSPY_ReadFun)0, (QSPY_ReadFun)0, (QSPY_ReadFun)0,
+        &QSPY_read8
+    };
+    QSpyParser * const p = QSPY_currParser;
+    QSpyUsrPlan * const plan = &p->usrPlan[me->rec - QSPY_SCHEMA_RECS];
+
+    if (!QSpyUsrPlan_matches(plan, me)) { // signature changed?
+        if (!QSpyUsrPlan_compile(plan, me)) {
+            return false;
+        }
+    }
+
+    QSpyRecData * const data = &p->recData;
+    for (uint8_t i = 0U; i < plan->nFld; ++i) {
+        QSpyPlanField const * const pf = &plan->fld[i];
+        uint64_t u = (*readBySize[pf->size])(&me->pos[pf->offs]);
+        QSpyField * const fld = &data->fld[data->nFld];
+        ++data->nFld;
+        fld->size = pf->size;
+        fld->num  = 1U;
+        if (pf->kind == QSPY_FLD_INT) { // sign-extend
+            unsigned const sh = 64U - 8U*pf->size;
+            fld->type  = QSPY_FLD_INT;
+            fld->val.i = (int64_t)(u << sh) >> sh;
+        }
+        else {
+            fld->type  = QSPY_FLD_UINT;
+            fld->val.u = u;
+        }
+    }
+    me->pos += plan->len;
+    me->len  = 0;
+    return true;
+}
+
 //============================================================================
 // application-specific (user) QS records...
 static void QSpyRecord_processUser(QSpyRecord * const me) {
@@ -559,6 +1325,8 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
     uint64_t u64;
     int32_t  i32;
     uint32_t u32;
+    char const *s;
+#ifdef QSPY_APP // printf() formats for the Matlab output
     static char const *ifmt[] = {
         "%li",   "%1li",  "%2li",  "%3li",
         "%4li",  "%5li",  "%6li",  "%7li",
@@ -589,6 +1357,7 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
         "%18"PRIu64, "%20"PRIu64, "%22"PRIu64, "%24"PRIu64,
         "%26"PRIu64, "%28"PRIu64, "%30"PRIu64, "%32"PRIu64
     };
+#endif
     static char const *efmt[] = {
         "%7.0e",   "%9.1e",   "%10.2e",  "%11.3e",
         "%12.4e",  "%13.5e",  "%14.6e",  "%15.7e",
@@ -596,13 +1365,26 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
         "%20.12e", "%21.13e", "%22.14e", "%23.15e",
     };
 
-    u32 = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-    i32 = Dictionary_find(&QSPY_usrDict, me->rec);
-    if (i32 >= 0) {
-        SNPRINTF_LINE("%010u %s", u32, Dictionary_at(&QSPY_usrDict, i32));
+    u32 = QSpyRecord_getTstamp(me);
+
+    // without any output, the records of a known signature are just decoded
+    if (QSPY_isHeadless() && QSpyRecord_decodeUser(me)) {
+        return;
     }
-    else {
-        SNPRINTF_LINE("%010u USER+%03d", u32, (int)(me->rec - QS_USER));
+
+    if (QSPY_TEXT_ON()) {
+        QSPY_output.len = 0; // start a new line
+        QSPY_appendDec(u32, false, 10U, '0');
+        i32 = Dictionary_find(&QSPY_usrDict, me->rec);
+        if (i32 >= 0) {
+            s = Dictionary_at(&QSPY_usrDict, i32);
+            QSPY_appendStr(" ", 1);
+            QSPY_appendStr(s, (int)strlen(s));
+        }
+        else {
+            QSPY_appendStr(" USER+", 6);
+            QSPY_appendDec((uint64_t)(me->rec - QS_USER), false, 3U, '0');
+        }
     }
 
     FPRINF_MATFILE("%d %u", (int)me->rec, u32);
@@ -614,56 +1396,54 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
         bool is_hex = (width == (uint32_t)QS_HEX_FMT);
         fmt &= 0x0FU;
 
-        SNPRINTF_APPEND("%c", ' ');
+        QSPY_appendStr(" ", 1);
         FPRINF_MATFILE("%c", ' ');
 
-        char const *s;
         switch (fmt) {
             case QS_I8_ENUM_FMT: {
                 if ((width & 0x8U) == 0U) { // QS_I8() data element
                     i32 = QSpyRecord_getInt32(me, 1);
-                    SNPRINTF_APPEND(ifmt[width], (long)i32);
+                    QSPY_appendInt(i32, width);
                     FPRINF_MATFILE(ifmt[width], (long)i32);
                 }
                 else { // QS_ENUM() data element
                     u32 = QSpyRecord_getUint32(me, 1);
-                    SNPRINTF_APPEND("%s",
-                        Dictionary_get(&QSPY_enumDict[width & 0x7U],
-                                       u32, (char *)0));
+                    if (QSPY_TEXT_ON()) {
+                        s = Dictionary_get(&QSPY_enumDict[width & 0x7U],
+                                           u32, (char *)0);
+                        QSPY_appendStr(s, (int)strlen(s));
+                    }
                     FPRINF_MATFILE(ufmt[1], (unsigned long)u32);
                 }
                 break;
             }
             case QS_U8_FMT: {
                 u32 = QSpyRecord_getUint32(me, 1);
-                SNPRINTF_APPEND(is_hex ? uhfmt[2] : ufmt[width],
-                                (unsigned long)u32);
+                QSPY_appendUns(u32, width, is_hex, 2U);
                 FPRINF_MATFILE(ufmt[width], (unsigned long)u32);
                 break;
             }
             case QS_I16_FMT: {
                 i32 = QSpyRecord_getInt32(me, 2);
-                SNPRINTF_APPEND(ifmt[width], (long)i32);
+                QSPY_appendInt(i32, width);
                 FPRINF_MATFILE(ifmt[width], (long)i32);
                 break;
             }
             case QS_U16_FMT: {
                 u32 = QSpyRecord_getUint32(me, 2);
-                SNPRINTF_APPEND(is_hex ? uhfmt[4] : ufmt[width],
-                                (unsigned long)u32);
+                QSPY_appendUns(u32, width, is_hex, 4U);
                 FPRINF_MATFILE(ufmt[width], (unsigned long)u32);
                 break;
             }
             case QS_I32_FMT: {
                 i32 = QSpyRecord_getInt32(me, 4);
-                SNPRINTF_APPEND(ifmt[width], (long)i32);
+                QSPY_appendInt(i32, width);
                 FPRINF_MATFILE(ifmt[width], (long)i32);
                 break;
             }
             case QS_U32_FMT: {
                 u32 = QSpyRecord_getUint32(me, 4);
-                SNPRINTF_APPEND(is_hex ? uhfmt[8] : ufmt[width],
-                                (unsigned long)u32);
+                QSPY_appendUns(u32, width, is_hex, 8U);
                 FPRINF_MATFILE(ufmt[width], (unsigned long)u32);
                 break;
             }
@@ -689,23 +1469,23 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
             }
             case QS_STR_FMT: {
                 s = QSpyRecord_getStr(me);
-                SNPRINTF_APPEND("%s", s);
+                QSPY_appendStr(s, (int)strlen(s));
                 FPRINF_MATFILE("%s", s);
                 break;
             }
             case QS_MEM_FMT: {
                 uint8_t const *mem = QSpyRecord_getMem(me, 1, &u32);
                 if (mem) {
+                    QSPY_appendMem(mem, u32);
                     for (; u32 > 0U; --u32, ++mem) {
-                        SNPRINTF_APPEND(" %02X", (unsigned int)*mem);
                         FPRINF_MATFILE(" %03d", (unsigned int)*mem);
                     }
                 }
                 break;
             }
             case QS_SIG_FMT: {
-                u32 = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-                u64 = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+                u32 = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+                u64 = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
                 if (u64 != 0U) {
                     SNPRINTF_APPEND("%s,Obj=%s",
                         SigDictionary_get(&QSPY_sigDict, u32, u64, (char *)0),
@@ -719,34 +1499,45 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
                 break;
             }
             case QS_OBJ_FMT: {
-                u64 = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-                SNPRINTF_APPEND("%s",
-                    Dictionary_get(&QSPY_objDict, u64, (char *)0));
+                u64 = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+                if (QSPY_TEXT_ON()) {
+                    s = Dictionary_get(&QSPY_objDict, u64, (char *)0);
+                    QSPY_appendStr(s, (int)strlen(s));
+                }
                 FPRINF_MATFILE("%"PRId64, u64);
                 break;
             }
             case QS_FUN_FMT: {
-                u64 = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
-                SNPRINTF_APPEND("%s",
-                    Dictionary_get(&QSPY_funDict, u64, (char *)0));
+                u64 = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
+                if (QSPY_TEXT_ON()) {
+                    s = Dictionary_get(&QSPY_funDict, u64, (char *)0);
+                    QSPY_appendStr(s, (int)strlen(s));
+                }
                 FPRINF_MATFILE("%"PRId64, u64);
                 break;
             }
             case QS_I64_FMT: {
                 i64 = QSpyRecord_getInt64(me, 8);
-                SNPRINTF_APPEND(ilfmt[width], i64);
+                QSPY_appendInt(i64, (width != 9U) ? 2U*(width + 1U) : 0U);
                 FPRINF_MATFILE(ilfmt[width], i64);
                 break;
             }
             case QS_U64_FMT: {
                 u64 = QSpyRecord_getUint64(me, 8);
-                SNPRINTF_APPEND(is_hex ? "0x%16"PRIX64 : ulfmt[width], u64);
+                if (is_hex) {
+                    QSPY_appendStr("0x", 2);
+                    QSPY_appendHex(u64, 16U, ' ');
+                }
+                else {
+                    QSPY_appendDec(u64, false, 2U*(width + 1U), ' ');
+                }
                 FPRINF_MATFILE(ulfmt[width], u64);
                 break;
             }
             case QS_HEX_FMT: {
                 u32 = QSpyRecord_getUint32(me, 4);
-                SNPRINTF_APPEND(uhfmt[width], (unsigned long)u32);
+                QSPY_appendStr("0x", 2);
+                QSPY_appendHex(u32, width, '0');
                 FPRINF_MATFILE(uhfmt[width], (unsigned long)u32);
                 break;
             }
@@ -757,10 +1548,92 @@ static void QSpyRecord_processUser(QSpyRecord * const me) {
             }
         }
     }
-    QSPY_onPrintLn();
+    QSPY_printLn();
     FPRINF_MATFILE("%c", '\n');
 }
 
+//============================================================================
+// target info...
+
+// decode the QS_TARGET_INFO record into the target configuration (starting
+// from the current QSPY_conf) without consuming or logging the record.
+// Returns the target-reset flag, or -1 for a record of a wrong length.
+static int QSpyRecord_getTrgInfo(QSpyRecord const * const me,
+                                 QSpyConfig * const trg)
+{
+    uint8_t const *pos = me->pos;
+    if (me->len < 1) {
+        return -1;
+    }
+    uint32_t const a = pos[0];
+    uint32_t t;
+    int rst;
+    *trg = QSPY_conf;
+    if ((a & 0x03U) == 0x02U) { // is this the new format?
+        if (me->len != 1 + 4 + 13) {
+            return -1;
+        }
+        t = ~((((((uint32_t)pos[4] << 8) | (uint32_t)pos[3]) << 8)
+                  | (uint32_t)pos[2]) << 8 | (uint32_t)pos[1]);
+        trg->endianness = (uint8_t)((a >> 7U) & 0x01U);
+        trg->qpType     = (uint8_t)((a >> 2U) & 0x03U);
+        rst = (int)((a >> 6U) & 0x01U);
+        pos += 1 + 4;
+    }
+    else { // old format
+        if (me->len != 1 + 2 + 13) {
+            return -1;
+        }
+        t = ((uint32_t)pos[2] << 8) | (uint32_t)pos[1];
+        trg->endianness = (uint8_t)((t >> 15) & 0x01U);
+        t = (t & 0x7FFFU);
+        trg->qpType     = 0U; // QP framework type (unknown)
+        rst = (int)(a & 0x01U);
+        pos += 1 + 2;
+    }
+    trg->qpVersion    = (uint16_t)(t % 10000U);
+    trg->qpDate       = (uint32_t)(t / 10000U);
+    trg->objPtrSize   = (uint8_t)(pos[3] & 0xFU);
+    trg->funPtrSize   = (uint8_t)((pos[3] >> 4) & 0xFU);
+    trg->tstampSize   = (uint8_t)(pos[4] & 0xFU);
+    trg->sigSize      = (uint8_t)(pos[0] & 0xFU);
+    trg->evtSize      = (uint8_t)((pos[0] >> 4) & 0xFU);
+    trg->queueCtrSize = (uint8_t)(pos[1] & 0x0FU);
+    trg->poolCtrSize  = (uint8_t)((pos[2] >> 4) & 0xFU);
+    trg->poolBlkSize  = (uint8_t)(pos[2] & 0xFU);
+    trg->tevtCtrSize  = (uint8_t)((pos[1] >> 4) & 0xFU);
+    memcpy(trg->tbuild, &pos[7], sizeof(trg->tbuild));
+    return rst;
+}
+//............................................................................
+bool QSpyRecord_isSessionEnd(QSpyRecord const * const me) {
+    if (me->rec != QS_TARGET_INFO) {
+        return false;
+    }
+    QSpyConfig trg;
+    int const rst = QSpyRecord_getTrgInfo(me, &trg);
+    if (rst != 0) {
+        return (rst > 0); // target reset (or a corrupted record)
+    }
+    // config changed and this is not the first target info?
+    return (trg.qpType != 0U)
+        && ((trg.qpDate       != QSPY_conf.qpDate)
+            || (trg.qpVersion    != QSPY_conf.qpVersion)
+            || (trg.qpType       != QSPY_conf.qpType)
+            || (trg.endianness   != QSPY_conf.endianness)
+            || (trg.objPtrSize   != QSPY_conf.objPtrSize)
+            || (trg.funPtrSize   != QSPY_conf.funPtrSize)
+            || (trg.tstampSize   != QSPY_conf.tstampSize)
+            || (trg.sigSize      != QSPY_conf.sigSize)
+            || (trg.evtSize      != QSPY_conf.evtSize)
+            || (trg.queueCtrSize != QSPY_conf.queueCtrSize)
+            || (trg.poolCtrSize  != QSPY_conf.poolCtrSize)
+            || (trg.poolBlkSize  != QSPY_conf.poolBlkSize)
+            || (trg.tevtCtrSize  != QSPY_conf.tevtCtrSize)
+            || (memcmp(trg.tbuild, QSPY_conf.tbuild,
+                       sizeof(trg.tbuild)) != 0));
+}
+
 //============================================================================
 // predefined QS records...
 static void QSpyRecord_process(QSpyRecord * const me) {
@@ -783,14 +1656,14 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QEP_STATE_EXIT: {
             if (s == 0) s = "St-Exit ";
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("===RTC===> %s Obj=%s,State=%s",
                        s,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %"PRId64" %"PRId64"\n",
                             (int)me->rec, p, q);
             }
@@ -807,48 +1680,48 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_RESERVED_57: { // previously QS_QEP_TRAN_XP
             if (s == 0) s = "St-XP   ";
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
-            r = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
+            r = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("===RTC===> %s Obj=%s,State=%s->%s",
                        s,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0),
                        Dictionary_get(&QSPY_funDict, r, buf));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %"PRId64" %"PRId64" %"PRId64"\n",
                                (int)me->rec, p, q, r);
             }
             break;
         }
         case QS_QEP_INIT_TRAN: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u Init===> Obj=%s,State=%s",
                        t,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64"\n",
                                (int)me->rec, t, p, q);
             }
             break;
         }
         case QS_QEP_INTERN_TRAN: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u =>Intern Obj=%s,Sig=%s,State=%s",
                        t,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64
                                " %"PRId64"\n",
                                (int)me->rec, t, a, p, q);
@@ -856,11 +1729,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             break;
         }
         case QS_QEP_TRAN: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
-            r = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
+            r = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 w = Dictionary_get(&QSPY_funDict, r, buf);
                 SNPRINTF_LINE("%010u ===>Tran "
@@ -870,11 +1743,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0),
                        w);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %"PRId64" %"PRId64"\n",
                                (int)me->rec, t, a, p, q, r);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     int obj = QSEQ_find(p);
                     if (obj >= 0) {
                         QSEQ_genTran(t, obj, w);
@@ -885,49 +1758,49 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             break;
         }
         case QS_QEP_IGNORED: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u =>Ignore Obj=%s,Sig=%s,State=%s",
                        t,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %"PRId64"\n",
                                (int)me->rec, t, a, p, q);
             }
             break;
         }
         case QS_QEP_DISPATCH: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u Disp===> Obj=%s,Sig=%s,State=%s",
                        t,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %"PRId64"\n",
                                (int)me->rec, t, a, p, q);
             }
             break;
         }
         case QS_QEP_UNHANDLED: {
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("===RTC===> St-Unhnd Obj=%s,Sig=%s,State=%s",
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        Dictionary_get(&QSPY_funDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64"\n",
                                (int)me->rec, a, p, q);
             }
@@ -943,10 +1816,10 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_ACTIVE_RECALL: {
             if (s == 0) s = "RCall";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -958,11 +1831,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                         Dictionary_get(&QSPY_objDict, q, (char *)0),
                         SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                         b, c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64" %u %u %u\n",
                                 (int)me->rec, t, p, q, a, b, c);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     int obj = QSEQ_find(p);
                     if (obj >= 0) {
                         QSEQ_genAnnotation(t, obj, s);
@@ -973,19 +1846,19 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             break;
         }
         case QS_QF_ACTIVE_RECALL_ATTEMPT: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u AO-RCllA Obj=%s,Que=%s",
                         t,
                         Dictionary_get(&QSPY_objDict, p, (char *)0),
                         Dictionary_get(&QSPY_objDict, q, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64"\n",
                                 (int)me->rec, t, p, q);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     int obj = QSEQ_find(p);
                     if (obj >= 0) {
                         QSEQ_genAnnotation(t, obj, "RCallA");
@@ -1001,16 +1874,16 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_ACTIVE_UNSUBSCRIBE: {
             if (s == 0) s = "Unsub";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u AO-%s Obj=%s,Sig=%s",
                        t,
                        s,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64"\n",
                                (int)me->rec, t, a, p);
             }
@@ -1021,14 +1894,14 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_ACTIVE_POST_ATTEMPT: {
             if (s == 0) s = "PostA";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
-            d = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
-            e = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
+            d = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
+            e = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
             if (QSpyRecord_OK(me)) {
                 w = SigDictionary_get(&QSPY_sigDict, a, p, (char *)0);
                 SNPRINTF_LINE("%010u AO-%s Sdr=%s,Obj=%s,"
@@ -1042,11 +1915,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        b, c, d,
                        (me->rec == QS_QF_ACTIVE_POST ? "Min" : "Mar"),
                        e);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %"PRId64" %u %u %u %u\n",
                                (int)me->rec, t, q, a, p, b, c, d, e);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     int src = QSEQ_find(q);
                     int dst = QSEQ_find(p);
                     QSEQ_genPost(t, src, dst, w,
@@ -1057,13 +1930,13 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             break;
         }
         case QS_QF_ACTIVE_POST_LIFO: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
-            d = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
-            e = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
+            d = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
+            e = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
             if (QSpyRecord_OK(me)) {
                 w = SigDictionary_get(&QSPY_sigDict, a, p, (char *)0);
                 SNPRINTF_LINE("%010u AO-LIFO  Obj=%s,"
@@ -1073,11 +1946,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        w,
                        b, c, d, e);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %u %u %u %u\n",
                                (int)me->rec, t, a, p, b, c, d, e);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     int src = QSEQ_find(p);
                     if (src >= 0) {
                         QSEQ_genPostLIFO(t, src, w);
@@ -1092,12 +1965,12 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_EQUEUE_GET: {
             if (s == 0) s = "EQ-Get  ";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
-            d = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
+            d = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u %s Obj=%s,Evt<Sig=%s,Pool=%u,Ref=%u>,"
                        "Que<Free=%u>",
@@ -1106,7 +1979,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        b, c, d);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %u %u %u\n",
                                (int)me->rec, t, a, p, b, c, d);
             }
@@ -1117,9 +1990,9 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_EQUEUE_GET_LAST: {
             if (s == 0) s = "EQ-GetL ";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1129,7 +2002,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, p, (char *)0),
                        b, c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %u %u\n",
                                (int)me->rec, t, a, p, b, c);
             }
@@ -1147,13 +2020,13 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         case QS_QF_EQUEUE_POST_LIFO: {
             if (s == 0) s = "LIFO";
             if (w == 0) w = "Min";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
-            d = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
-            e = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
+            d = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
+            e = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u EQ-%s Obj=%s,"
                        "Evt<Sig=%s,Pool=%u,Ref=%u>,"
@@ -1165,7 +2038,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        b, c, d,
                        w,
                        e);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %"PRId64" %u %u %u %u\n",
                                (int)me->rec, t, a, p,
                                b, c, d, e);
@@ -1180,10 +2053,10 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         case QS_QF_MPOOL_GET_ATTEMPT: {
             if (s == 0) s = "GetA ";
             if (w == 0) w = "Mar";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            b = QSpyRecord_getUint32(me, QSPY_conf.poolCtrSize);
-            c = QSpyRecord_getUint32(me, QSPY_conf.poolCtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            b = QSpyRecord_getCfg32(me, QSPY_SZ_PCTR);
+            c = QSpyRecord_getCfg32(me, QSPY_SZ_PCTR);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u MP-%s Obj=%s,Free=%u,%s=%u",
                        t,
@@ -1192,22 +2065,22 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        b,
                        w,
                        c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %u\n",
                                (int)me->rec, t, p, b, c);
             }
             break;
         }
         case QS_QF_MPOOL_PUT: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            b = QSpyRecord_getUint32(me, QSPY_conf.poolCtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            b = QSpyRecord_getCfg32(me, QSPY_SZ_PCTR);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u MP-Put   Obj=%s,Free=%u",
                        t,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        b);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u\n",
                                (int)me->rec, t, p, b);
             }
@@ -1220,15 +2093,15 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_NEW: {
             if (s == 0) s = "QF-New  ";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.evtSize);
-            c = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_EVT);
+            c = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u %s Sig=%s,Size=%u",
                        t, s,
                        SigDictionary_get(&QSPY_sigDict, c, 0, (char *)0),
                        a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u\n",
                                (int)me->rec, t, a, c);
             }
@@ -1236,9 +2109,9 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         }
 
         case QS_QF_PUBLISH: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1249,11 +2122,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        w,
                        b, c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %u\n",
                                (int)me->rec, t, p, a, b);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     int obj = QSEQ_find(p);
                     QSEQ_genPublish(t, obj, w);
                 }
@@ -1263,8 +2136,8 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         }
 
         case QS_QF_NEW_REF: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1272,7 +2145,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        t,
                        SigDictionary_get(&QSPY_sigDict, a, 0, (char *)0),
                        b, c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u %u\n",
                                (int)me->rec, t, a, b, c);
             }
@@ -1280,8 +2153,8 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         }
 
         case QS_QF_DELETE_REF: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1289,7 +2162,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                         t,
                         SigDictionary_get(&QSPY_sigDict, a, 0, (char *)0),
                         b, c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u %u\n",
                                 (int)me->rec, t, a, b, c);
             }
@@ -1301,8 +2174,8 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_GC: {
             if (s == 0) s = "QF-gc   ";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+            t = QSpyRecord_getTstamp(me);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
             b = QSpyRecord_getUint32(me, 1);
             c = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1311,23 +2184,23 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        s,
                        SigDictionary_get(&QSPY_sigDict, a, 0, (char *)0),
                        b, c);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u %u\n",
                                (int)me->rec, t, a, b, c);
             }
             break;
         }
         case QS_QF_TICK: {
-            a = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("           Tick<%1u>  Ctr=%010u",
                         b,
                         a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u\n", (int)me->rec, a);
 #ifdef QSPY_APP
-                if (QSEQ_isActive()) {
+                if (QSEQ_isActive() && QSPY_IS_HOST()) {
                     QSEQ_genTick(b, a);
                 }
 #endif
@@ -1339,11 +2212,11 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_TIMEEVT_DISARM: {
             if (s == 0) s = "Dis ";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            c = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
-            d = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            c = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
+            d = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u TE%1u-%s Obj=%s,AO=%s,Tim=%u,Int=%u",
@@ -1353,31 +2226,31 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_objDict, q, buf),
                        c, d);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64" %u %u\n",
                                (int)me->rec, t, p, q, c, d);
             }
             break;
         }
         case QS_QF_TIMEEVT_AUTO_DISARM: {
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("           TE%1u-ADis Obj=%s,AO=%s",
                        b,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_objDict, q, buf));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %"PRId64" %"PRId64"\n",
                                (int)me->rec, p, q);
            }
             break;
         }
         case QS_QF_TIMEEVT_DISARM_ATTEMPT: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u TE%1u-DisA Obj=%s,AO=%s",
@@ -1385,18 +2258,18 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        b,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_objDict, q, buf));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64"\n",
                                (int)me->rec, t, p, q);
             }
             break;
         }
         case QS_QF_TIMEEVT_REARM: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            c = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
-            d = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            c = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
+            d = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
             b = QSpyRecord_getUint32(me, 1);
             e = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1407,17 +2280,17 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        Dictionary_get(&QSPY_objDict, q, buf),
                        c, d, e);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %"PRId64" %u %u %u\n",
                                (int)me->rec, t, p, q, c, d, e);
             }
             break;
         }
         case QS_QF_TIMEEVT_POST: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u TE%1u-Post Obj=%s,Sig=%s,AO=%s",
@@ -1426,7 +2299,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        SigDictionary_get(&QSPY_sigDict, a, q, (char *)0),
                        Dictionary_get(&QSPY_objDict, q, buf));
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %"PRId64"\n",
                                (int)me->rec, t, p, a, q);
             }
@@ -1435,16 +2308,22 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         case QS_QF_CRIT_ENTRY:
             s = "QF-CritE";
             //lint -fallthrough
-        case QS_QF_CRIT_EXIT: {
+        case QS_QF_CRIT_EXIT:
             if (s == 0) s = "QF-CritX";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            //lint -fallthrough
+        case QS_QF_INT_DISABLE:
+            if (s == 0) s = "QF-IntD ";
+            //lint -fallthrough
+        case QS_QF_INT_ENABLE: {
+            if (s == 0) s = "QF-IntE ";
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u %s Nest=%d",
                        t,
                        s,
                        a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u\n",
                                (int)me->rec, t, a);
            }
@@ -1455,7 +2334,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_QF_ISR_EXIT: {
             if (s == 0) s = "QF-IsrX";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1463,7 +2342,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        t,
                        s,
                        a, b);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u\n",
                                (int)me->rec, t, a, b);
             }
@@ -1481,7 +2360,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             }
             //lint -fallthrough
         case QS_SCHED_RESTORE: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1490,7 +2369,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                     if (s == 0) s = "Mtx-Unlk";
                     SNPRINTF_LINE("%010u %s Pro=%u,Ceil=%u",
                            t, s, a, b);
-                    QSPY_onPrintLn();
+                    QSPY_printLn();
                     FPRINF_MATFILE("%d %u %u %u\n",
                                    (int)me->rec, t, a, b);
                 }
@@ -1498,7 +2377,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                     if (s == 0) s = "Sch-Rest";
                     SNPRINTF_LINE("%010u %s Pri=%u->%u",
                            t, s, b, a);
-                    QSPY_onPrintLn();
+                    QSPY_printLn();
                     FPRINF_MATFILE("%d %u %u %u\n",
                                    (int)me->rec, t, b, a);
                 }
@@ -1511,7 +2390,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_SCHED_UNLOCK: {
             if (s == 0) s = "Sch-Unlk";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -1519,32 +2398,32 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        t,
                        s,
                        a, b);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u\n",
                                (int)me->rec, t, a, b);
             }
             break;
         }
         case QS_SCHED_NEXT: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u Sch-Next Pri=%u->%u",
                        t, b, a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %u\n",
                                (int)me->rec, t, a, b);
             }
             break;
         }
         case QS_SCHED_IDLE: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u Sch-Idle Pri=%u->0",
                        t, a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u\n",
                                (int)me->rec, t, a);
             }
@@ -1560,7 +2439,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                 Dictionary_put(&QSPY_enumDict[b], a, s);
                 SNPRINTF_LINE("           Enum-Dic %03d,Grp=%1d->%s",
                               a, b, s);
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
@@ -1569,27 +2448,27 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         case QS_TEST_PAUSED: {
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("           %s", "TstPause");
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
 
         case QS_TEST_PROBE_GET: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             a = QSpyRecord_getUint32(me, 4U);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u TstProbe Fun=%s,Data=%d",
                               t, Dictionary_get(&QSPY_funDict,
                               q, (char *)0), a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
 
         case QS_SIG_DICT: {
-            a = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            a = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             s = QSpyRecord_getStr(me);
             if (QSpyRecord_OK(me)) {
                 SigDictionary_put(&QSPY_sigDict, (SigType)a, p, s);
@@ -1603,7 +2482,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                                   "Obj=0x%016"PRIX64"->%s",
                                   a, p, s);
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %s=[%u %"PRId64"];\n",
                                (int)me->rec, QSPY_getMatDict(s), a, p);
             }
@@ -1611,20 +2490,28 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         }
 
         case QS_OBJ_DICT: {
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             s = QSpyRecord_getStr(me);
 
             // for backward compatibility replace the '['/']' with '<'/'>'
-            if (QSPY_conf.qpVersion < 690U) {
-                char *ps;
-                for (ps = (char *)s; *ps != '\0'; ++ps) {
-                    if (*ps == '[') {
-                        *ps = '<';
+            // NOTE: the record might be the caller's (read-only) buffer,
+            // so the replacement is done in a copy of the name
+            char name[QS_RECORD_SIZE_MAX];
+            if ((QSPY_conf.qpVersion < 690U) && (s != (char const *)0)) {
+                size_t i;
+                for (i = 0U; (s[i] != '\0') && (i < sizeof(name) - 1U); ++i) {
+                    if (s[i] == '[') {
+                        name[i] = '<';
+                    }
+                    else if (s[i] == ']') {
+                        name[i] = '>';
                     }
-                    else if (*ps == ']') {
-                        *ps = '>';
+                    else {
+                        name[i] = s[i];
                     }
                 }
+                name[i] = '\0';
+                s = name;
             }
             if (QSpyRecord_OK(me)) {
                 Dictionary_put(&QSPY_objDict, p, s);
@@ -1636,19 +2523,21 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                     SNPRINTF_LINE("           Obj-Dict 0x%016"PRIX64"->%s",
                                   p, s);
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %s=%"PRId64";\n",
                                (int)me->rec, QSPY_getMatDict(s), p);
 #ifdef QSPY_APP
                 // if needed, update the object in the Sequence dictionary
-                QSEQ_updateDictionary(s, p);
+                if (QSPY_IS_HOST()) {
+                    QSEQ_updateDictionary(s, p);
+                }
 #endif
             }
             break;
         }
 
         case QS_FUN_DICT: {
-            p = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
             s = QSpyRecord_getStr(me);
             if (QSpyRecord_OK(me)) {
                 Dictionary_put(&QSPY_funDict, p, s);
@@ -1660,7 +2549,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                     SNPRINTF_LINE("           Fun-Dict 0x%016"PRIX64"->%s",
                                   p, s);
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %s=%"PRId64";\n",
                             (int)me->rec, QSPY_getMatDict(s), p);
             }
@@ -1674,12 +2563,14 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                 Dictionary_put(&QSPY_usrDict, a, s);
                 SNPRINTF_LINE("           Usr-Dict %08d->%s",
                         a, s);
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
 
         case QS_TARGET_INFO: {
+            // evaluated before the target info is applied to QSPY_conf
+            bool const sessionEnd = QSpyRecord_isSessionEnd(me);
             a = QSpyRecord_getUint32(me, 1);
             if ((a & 0x03U) == 0x02U) { // is this the new format?
                 t = ~QSpyRecord_getUint32(me, 4); // QP-version/QP-date
@@ -1723,6 +2614,9 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                 for (e = 0U; e < sizeof(QSPY_conf.tbuild); ++e) {
                     CONFIG_UPDATE(tbuild[e], (uint8_t)buf[7U + e], d);
                 }
+                if (d != 0U) {
+                    QSpyParser_updateLayout(QSPY_currParser);
+                }
 
                 SNPRINTF_LINE("           %s QP-Ver=%u,"
                        "Build=%02u%02u%02u_%02u%02u%02u",
@@ -1734,27 +2628,33 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        (unsigned)QSPY_conf.tbuild[2],
                        (unsigned)QSPY_conf.tbuild[1],
                        (unsigned)QSPY_conf.tbuild[0]);
-                QSPY_onPrintLn();
+                QSPY_printLn();
 
                 if (a != 0U) {  // is this Target RESET?
+                    QSpyClock_restart(&QSPY_currParser->clock);
+
                     // always reset dictionaries upon target reset
                     QSPY_resetAllDictionaries();
 #ifdef QSPY_APP
                     // should external dictionaries be used (-d option)?
-                    if (QDIC_isActive()) {
+                    if (QDIC_isActive() && QSPY_IS_HOST()) {
                         QSPY_readDict();
                     }
-                    QSPY_configChanged();
+                    if (QSPY_IS_HOST()) {
+                        QSPY_configChanged();
+                    }
 #endif
                     //TBD: close and re-open MATLAB, Sequence file, etc.
 
                     // reset the QSPY-Tx channel, if available
-                    if (l_txResetFun != (QSPY_resetFun)0) {
+                    if ((l_txResetFun != (QSPY_resetFun)0)
+                        && QSPY_IS_HOST())
+                    {
                         (*l_txResetFun)();
                     }
                 }
                 // config changed and this is not the first target info?
-                else if ((d != 0U) && (c != 0U)) {
+                else if (sessionEnd) {
                     // reset dictionaries upon config change
                     QSPY_resetAllDictionaries();
                     SNPRINTF_LINE("   <QSPY-> %s",
@@ -1762,10 +2662,12 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                     QSPY_printInfo();
 #ifdef QSPY_APP
                     // should external dictionaries be used (-d option)?
-                    if (QDIC_isActive()) {
+                    if (QDIC_isActive() && QSPY_IS_HOST()) {
                         QSPY_readDict();
                     }
-                    QSPY_configChanged();
+                    if (QSPY_IS_HOST()) {
+                        QSPY_configChanged();
+                    }
 #endif
                 }
             }
@@ -1773,7 +2675,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         }
 
         case QS_TARGET_DONE: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1U);
             if (QSpyRecord_OK(me)) {
                 if (a < sizeof(l_qs_rx_rec)/sizeof(l_qs_rx_rec[0])) {
@@ -1784,7 +2686,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                     SNPRINTF_LINE("%010u Trg-Done %d",
                                  t, a);
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
@@ -1812,13 +2714,13 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                         SNPRINTF_LINE("           Trg-ERR  0x%02X", a);
                     }
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
 
         case QS_QUERY_DATA: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 1U);
             b = 0;
             c = 0;
@@ -1828,25 +2730,25 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             p = 0;
             q = 0;
             if (QSPY_conf.qpVersion < 810U) {
-                p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+                p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
                 switch (a) {
                     case QS_OBJ_SM: //lint -fallthrough
                     case QS_OBJ_AO:
-                        q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+                        q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
                         break;
                     case QS_OBJ_MP:
-                        b = QSpyRecord_getUint32(me, QSPY_conf.poolCtrSize);
-                        c = QSpyRecord_getUint32(me, QSPY_conf.poolCtrSize);
+                        b = QSpyRecord_getCfg32(me, QSPY_SZ_PCTR);
+                        c = QSpyRecord_getCfg32(me, QSPY_SZ_PCTR);
                         break;
                     case QS_OBJ_EQ:
-                        b = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
-                        c = QSpyRecord_getUint32(me, QSPY_conf.queueCtrSize);
+                        b = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
+                        c = QSpyRecord_getCfg32(me, QSPY_SZ_QCTR);
                         break;
                     case QS_OBJ_TE:
-                        q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-                        b = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
-                        c = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
-                        d = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+                        q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+                        b = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
+                        c = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
+                        d = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
                         e = QSpyRecord_getUint32(me, 1);
                         break;
                     case QS_OBJ_AP:
@@ -1887,13 +2789,13 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                             break;
                     }
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             else { // new queries
                 switch (a) {
                     case QS_OBJ_SM:
-                        p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-                        q = QSpyRecord_getUint64(me, QSPY_conf.funPtrSize);
+                        p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+                        q = QSpyRecord_getCfg64(me, QSPY_SZ_FUN);
                         break;
                     case QS_OBJ_AO:
                         b = QSpyRecord_getUint32(me, 1U);
@@ -1902,24 +2804,24 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                         e = QSpyRecord_getUint32(me, 2U);
                         break;
                     case QS_OBJ_MP:
-                        p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+                        p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
                         b = QSpyRecord_getUint32(me, 2U);
                         c = QSpyRecord_getUint32(me, 2U);
                         d = QSpyRecord_getUint32(me, 2U);
                         e = QSpyRecord_getUint32(me, 2U);
                         break;
                     case QS_OBJ_EQ:
-                        p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+                        p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
                         b = QSpyRecord_getUint32(me, 2U);
                         c = QSpyRecord_getUint32(me, 2U);
                         d = QSpyRecord_getUint32(me, 2U);
                         break;
                     case QS_OBJ_TE:
-                        p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-                        q = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
-                        b = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
-                        c = QSpyRecord_getUint32(me, QSPY_conf.tevtCtrSize);
-                        d = QSpyRecord_getUint32(me, QSPY_conf.sigSize);
+                        p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+                        q = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
+                        b = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
+                        c = QSpyRecord_getCfg32(me, QSPY_SZ_TCTR);
+                        d = QSpyRecord_getCfg32(me, QSPY_SZ_SIG);
                         e = QSpyRecord_getUint32(me, 1U);
                         break;
                     case QS_OBJ_EP:
@@ -1974,13 +2876,13 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                             break;
                     }
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
 
         case QS_PEEK_DATA: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 2);  // offset
             b = QSpyRecord_getUint32(me, 1);  // data size
             w = (char const *)QSpyRecord_getMem(me, (uint8_t)b, &c);
@@ -1990,42 +2892,46 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                 for (; c > 1U; --c, w += b) {
                     switch (b) {
                         case 1:
-                            SNPRINTF_APPEND("%02X,", (int)(*w & 0xFFU));
+                            QSPY_appendHex(*w & 0xFFU, 2U, '0');
+                            QSPY_appendStr(",", 1);
                             break;
                         case 2:
-                            SNPRINTF_APPEND("%04X,",
-                                (int)(*(uint16_t *)w & 0xFFFFU));
+                            QSPY_appendHex(*(uint16_t *)w & 0xFFFFU, 4U, '0');
+                            QSPY_appendStr(",", 1);
                             break;
                         case 4:
-                            SNPRINTF_APPEND("%08X,", (int)(*(uint32_t *)w));
+                            QSPY_appendHex(*(uint32_t *)w, 8U, '0');
+                            QSPY_appendStr(",", 1);
                             break;
                     }
                 }
                 switch (b) {
                     case 1:
-                        SNPRINTF_APPEND("%02X>", (int)(*w & 0xFFU));
+                        QSPY_appendHex(*w & 0xFFU, 2U, '0');
+                        QSPY_appendStr(">", 1);
                         break;
                     case 2:
-                        SNPRINTF_APPEND("%04X>",
-                            (int)(*(uint16_t *)w & 0xFFFFU));
+                        QSPY_appendHex(*(uint16_t *)w & 0xFFFFU, 4U, '0');
+                        QSPY_appendStr(">", 1);
                         break;
                     case 4:
-                        SNPRINTF_APPEND("%08X>", (int)(*(uint32_t *)w));
+                        QSPY_appendHex(*(uint32_t *)w, 8U, '0');
+                        QSPY_appendStr(">", 1);
                         break;
                 }
-                QSPY_onPrintLn();
+                QSPY_printLn();
             }
             break;
         }
 
         case QS_ASSERT_FAIL: {
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
+            t = QSpyRecord_getTstamp(me);
             a = QSpyRecord_getUint32(me, 2);
             s = QSpyRecord_getStr(me);
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("%010u =ASSERT= Mod=%s,Loc=%u",
                        t, s, a);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %u %s\n",
                             (int)me->rec, (unsigned)t, (unsigned)a, s);
             }
@@ -2035,9 +2941,16 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         case QS_QF_RUN: {
             if (QSpyRecord_OK(me)) {
                 SNPRINTF_LINE("           %s", "QF_RUN");
-                QSPY_onPrintLn();
+                QSPY_printLn();
+                uint32_t dropped = QSPY_getDictDropped();
+                if (dropped > 0U) {
+                    SNPRINTF_LINE("   <QSPY-> Dictionaries full "
+                                  "(%u entries dropped)", (unsigned)dropped);
+                    QSPY_printInfo();
+                }
 #ifdef QSPY_APP
-                if (QDIC_isActive()) {
+                if (QDIC_isActive() && QSPY_IS_HOST()) {
+                    QSPY_sortAllDictionaries();
                     QSPY_writeDict();
                 }
 #endif
@@ -2057,8 +2970,8 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_SEM_BLOCK_ATTEMPT: {
             if (s == 0) s = "Sem-BlkA";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -2067,7 +2980,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        s,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        a, b);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %u\n",
                                (int)me->rec, (unsigned)t, p, a, b);
             }
@@ -2086,8 +2999,8 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_MTX_UNLOCK_ATTEMPT: {
             if (s == 0) s = "Mtx-UlkA";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -2096,7 +3009,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        s,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        a, b);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %u\n",
                                (int)me->rec, (unsigned)t, p, a, b);
             }
@@ -2107,8 +3020,8 @@ static void QSpyRecord_process(QSpyRecord * const me) {
             //lint -fallthrough
         case QS_MTX_BLOCK_ATTEMPT: {
             if (s == 0) s = "Mtx-BlkA";
-            t = QSpyRecord_getUint32(me, QSPY_conf.tstampSize);
-            p = QSpyRecord_getUint64(me, QSPY_conf.objPtrSize);
+            t = QSpyRecord_getTstamp(me);
+            p = QSpyRecord_getCfg64(me, QSPY_SZ_OBJ);
             a = QSpyRecord_getUint32(me, 1);
             b = QSpyRecord_getUint32(me, 1);
             if (QSpyRecord_OK(me)) {
@@ -2117,7 +3030,7 @@ static void QSpyRecord_process(QSpyRecord * const me) {
                        s,
                        Dictionary_get(&QSPY_objDict, p, (char *)0),
                        a, b);
-                QSPY_onPrintLn();
+                QSPY_printLn();
                 FPRINF_MATFILE("%d %u %"PRId64" %u %u\n",
                                (int)me->rec, (unsigned)t, p, a, b);
             }
@@ -2131,173 +3044,729 @@ static void QSpyRecord_process(QSpyRecord * const me) {
         default: {
             SNPRINTF_LINE("           Unknown Rec=%d,Len=%d",
                    (int)me->rec, (int)me->len);
-            QSPY_onPrintLn();
+            QSPY_printLn();
             break;
         }
     }
 }
 //............................................................................
-void QSPY_printInfo(void) {
-    QSPY_output.type = INF_OUT; // this is an internal info message
-    QSPY_onPrintLn();
-}
+void QSPY_printLn(void) {
+    if (QSPY_TEXT_ON()) {
+        (*QSPY_currParser->printLnFun)();
+    }
+    else { // no text sink, discard the (not rendered) line
+        QSPY_output.type = REG_OUT;
+    }
+}
+//............................................................................
+void QSPY_printInfo(void) {
+    QSPY_output.type = INF_OUT; // this is an internal info message
+    QSPY_printLn();
+}
 //............................................................................
 void QSPY_printError(void) {
     QSPY_output.type = ERR_OUT; // this is an error message
-    QSPY_onPrintLn();
+    QSPY_printLn();
 }
 
 //============================================================================
-static uint8_t l_record[QS_RECORD_SIZE_MAX];
-static uint8_t *l_pos   = l_record; // position within the record
-static uint8_t l_chksum = 0U;
-static uint8_t l_esc    = 0U;
-static uint8_t l_seq    = 0U;
+//............................................................................
+// find the first QS_FRAME or QS_ESC byte in the given buffer
+// returns the number of "clean" bytes preceding it (nBytes if not found)
+static uint32_t QSPY_findDelim(uint8_t const *buf, uint32_t nBytes) {
+    uint32_t i = 0U;
+#if defined(QSPY_SIMD_SSE2)
+    __m128i const frame = _mm_set1_epi8((char)QS_FRAME);
+    __m128i const esc   = _mm_set1_epi8((char)QS_ESC);
+    for (; (i + 16U) <= nBytes; i += 16U) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&buf[i]);
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, frame), _mm_cmpeq_epi8(v, esc)));
+        if (mask != 0U) { // any delimiter in this block?
+            while ((mask & 1U) == 0U) {
+                mask >>= 1U;
+                ++i;
+            }
+            return i;
+        }
+    }
+#elif defined(QSPY_SIMD_NEON)
+    uint8x16_t const frame = vdupq_n_u8(QS_FRAME);
+    uint8x16_t const esc   = vdupq_n_u8(QS_ESC);
+    for (; (i + 16U) <= nBytes; i += 16U) {
+        uint8x16_t v = vld1q_u8(&buf[i]);
+        uint8x16_t m = vorrq_u8(vceqq_u8(v, frame), vceqq_u8(v, esc));
+        if (vmaxvq_u8(m) != 0U) { // any delimiter in this block?
+            break; // locate it with the scalar loop below
+        }
+    }
+#endif
+    // scalar path (also the reference implementation)
+    for (; i < nBytes; ++i) {
+        if ((buf[i] == QS_FRAME) || (buf[i] == QS_ESC)) {
+            break;
+        }
+    }
+    return i;
+}
+//............................................................................
+// copy the "clean" bytes to dst and return their sum (modulo 256)
+static uint8_t QSPY_copySum(uint8_t *dst,
+                            uint8_t const *src, uint32_t nBytes)
+{
+    uint32_t i = 0U;
+    uint32_t sum = 0U;
+#if defined(QSPY_SIMD_SSE2)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; (i + 16U) <= nBytes; i += 16U) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&src[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], v);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero)); // horizontal sum
+    }
+    sum = (uint32_t)_mm_cvtsi128_si32(acc)
+          + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#elif defined(QSPY_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0U);
+    for (; (i + 16U) <= nBytes; i += 16U) {
+        uint8x16_t v = vld1q_u8(&src[i]);
+        vst1q_u8(&dst[i], v);
+        acc = vpadalq_u16(acc, vpaddlq_u8(v)); // pairwise widening sum
+    }
+    sum = vaddvq_u32(acc);
+#endif
+    // scalar path (also the reference implementation)
+    for (; i < nBytes; ++i) {
+        dst[i] = src[i];
+        sum += src[i];
+    }
+    return (uint8_t)sum;
+}
+//............................................................................
+// return the sum (modulo 256) of the "clean" bytes without copying them
+static uint8_t QSPY_sum(uint8_t const *src, uint32_t nBytes) {
+    uint32_t i = 0U;
+    uint32_t sum = 0U;
+#if defined(QSPY_SIMD_SSE2)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; (i + 16U) <= nBytes; i += 16U) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&src[i]);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero)); // horizontal sum
+    }
+    sum = (uint32_t)_mm_cvtsi128_si32(acc)
+          + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#elif defined(QSPY_SIMD_NEON)
+    uint32x4_t acc = vdupq_n_u32(0U);
+    for (; (i + 16U) <= nBytes; i += 16U) {
+        acc = vpadalq_u16(acc, vpaddlq_u8(vld1q_u8(&src[i])));
+    }
+    sum = vaddvq_u32(acc);
+#endif
+    // scalar path (also the reference implementation)
+    for (; i < nBytes; ++i) {
+        sum += src[i];
+    }
+    return (uint8_t)sum;
+}
+//............................................................................
+void QSpyParser_init(QSpyParser * const me,
+                     QSpyConfig const *config,
+                     QSPY_CustParseFun custParseFun)
+{
+    me->conf = *config; // copy over
+    me->custParseFun = custParseFun;
+
+    Dictionary_ctor(&me->funDict, QSPY_FUN_DICT_MAX);
+    Dictionary_config(&me->funDict, me->conf.funPtrSize);
+
+    Dictionary_ctor(&me->objDict, QSPY_OBJ_DICT_MAX);
+    Dictionary_config(&me->objDict, me->conf.objPtrSize);
+
+    Dictionary_ctor(&me->usrDict, QSPY_USR_DICT_MAX);
+    Dictionary_config(&me->usrDict, 1);
+
+    SigDictionary_ctor(&me->sigDict, QSPY_SIG_DICT_MAX);
+    SigDictionary_config(&me->sigDict, me->conf.objPtrSize);
+
+    for (unsigned i = 0U;
+         i < sizeof(me->enumDict)/sizeof(me->enumDict[0]);
+         ++i)
+    {
+        Dictionary_ctor(&me->enumDict[i], QSPY_ENUM_DICT_MAX);
+        Dictionary_config(&me->enumDict[i], 1);
+    }
 
+    me->conf.qpDate = 0U; // invalidate the date to indicate "no-target-info"
+
+    me->output.len  = 0;
+    me->output.rec  = 0;
+    me->output.type = REG_OUT;
+    me->output.rx_status = -1;
+    me->printLnFun = &QSPY_onPrintLn;
+    me->textOn = true;
+    me->onRecordFun = (QSPY_RecordFun)0;
+    me->recData.nFld = 0U;
+    me->batch = (QSpyBatch *)0;
+    QSpyParser_resetStats(me);
+    memset(&me->clock, 0, sizeof(me->clock));
+
+    me->record     = me->recordSto;
+    me->recordSize = sizeof(me->recordSto);
+    QSpyParser_updateLayout(me);
+
+    me->isJustStarted = true;
+    QSpyParser_reset(me);
+}
+//............................................................................
+void QSpyParser_reset(QSpyParser * const me) {
+    me->pos    = me->record; // position within the record
+    me->chksum = 0U;
+    me->esc    = 0U;
+    me->seq    = 0U;
+}
+//............................................................................
+void QSpyParser_xtor(QSpyParser * const me) {
+    if (me->record != me->recordSto) {
+        free(me->record);
+        me->record     = me->recordSto;
+        me->recordSize = sizeof(me->recordSto);
+        me->pos        = me->record;
+    }
+    Dictionary_xtor(&me->funDict);
+    Dictionary_xtor(&me->objDict);
+    Dictionary_xtor(&me->usrDict);
+    SigDictionary_xtor(&me->sigDict);
+    for (unsigned i = 0U;
+         i < sizeof(me->enumDict)/sizeof(me->enumDict[0]);
+         ++i)
+    {
+        Dictionary_xtor(&me->enumDict[i]);
+    }
+}
+//............................................................................
+QSpyStatus QSpyParser_configRecordSize(QSpyParser * const me,
+                                       uint32_t size)
+{
+    if ((size < 3U) || (size > QS_RECORD_SIZE_LIMIT)) {
+        return QSPY_ERROR;
+    }
+    uint8_t *record = me->recordSto;
+    if (size > sizeof(me->recordSto)) {
+        record = (me->record != me->recordSto)
+                 ? (uint8_t *)realloc(me->record, size)
+                 : (uint8_t *)malloc(size);
+        if (record == (uint8_t *)0) {
+            return QSPY_ERROR; // the current buffer remains in use
+        }
+    }
+    else if (me->record != me->recordSto) {
+        free(me->record);
+    }
+    me->record     = record;
+    me->recordSize = size;
+    me->pos        = record; // any partially received record is dropped
+    me->chksum     = 0U;
+    me->esc        = 0U;
+    return QSPY_SUCCESS;
+}
+//............................................................................
+// copy all the entries of the other dictionary
+static void Dictionary_copy(Dictionary * const me,
+                            Dictionary const * const other)
+{
+    for (int k = 0; k < other->entries; ++k) {
+        Dictionary_put(me, other->sto[k].key, other->sto[k].name);
+    }
+}
+//............................................................................
+// copy the configuration, the dictionaries and the hooks of the other parser
+// (the framing state of the new parser is reset)
+void QSpyParser_clone(QSpyParser * const me,
+                      QSpyParser const * const other)
+{
+    QSpyParser_init(me, &other->conf, other->custParseFun);
+    me->conf = other->conf; // including the target info (qpDate)
+    QSpyParser_updateLayout(me);
+    if (other->recordSize != me->recordSize) {
+        (void)QSpyParser_configRecordSize(me, other->recordSize);
+    }
+
+    Dictionary_copy(&me->funDict, &other->funDict);
+    Dictionary_copy(&me->objDict, &other->objDict);
+    Dictionary_copy(&me->usrDict, &other->usrDict);
+    for (int k = 0; k < other->sigDict.entries; ++k) {
+        SigDictEntry const *e = &other->sigDict.sto[k];
+        SigDictionary_put(&me->sigDict, e->sig, e->obj, e->name);
+    }
+    for (unsigned i = 0U;
+         i < sizeof(me->enumDict)/sizeof(me->enumDict[0]);
+         ++i)
+    {
+        Dictionary_copy(&me->enumDict[i], &other->enumDict[i]);
+    }
+
+    me->printLnFun  = other->printLnFun;
+    me->textOn      = other->textOn;
+    me->onRecordFun = other->onRecordFun;
+    me->ctx         = other->ctx;
+}
 //............................................................................
 void QSPY_reset(void) {
-    l_pos    = l_record; // position within the record
-    l_chksum = 0U;
-    l_esc    = 0U;
-    l_seq    = 0U;
+    QSpyParser_reset(QSPY_currParser);
 }
 //............................................................................
 void QSPY_parse(uint8_t const *buf, uint32_t nBytes) {
-    static bool isJustStarted = true;
+    QSpyParser_parse(QSPY_currParser, buf, nBytes);
+}
+//............................................................................
+void QSpyBatch_clear(QSpyBatch * const me) {
+    me->nLines  = 0U;
+    me->textLen = 0U;
+    me->nRecs   = 0U;
+    me->nLost   = 0U;
+}
+//............................................................................
+// copy n bytes to the batch text, returns the copy or NULL if no room
+static char *QSpyBatch_putText(QSpyBatch * const me,
+                               void const *src, uint32_t n)
+{
+    if ((me->text == (char *)0) || (me->textSize - me->textLen < n + 1U)) {
+        ++me->nLost;
+        return (char *)0;
+    }
+    char *dst = &me->text[me->textLen];
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+    me->textLen += n + 1U;
+    return dst;
+}
+//............................................................................
+// output hook of the parser filling a batch
+static void QSpyBatch_printLn(void) {
+    QSpyBatch * const me = QSPY_currParser->batch;
+    if (me->nLines < me->maxLines) {
+        char const *line = QSpyBatch_putText(me, QSPY_line,
+                                             (uint32_t)QSPY_output.len);
+        if (line != (char const *)0) {
+            QSpyBatchLine *ln = &me->lines[me->nLines];
+            ++me->nLines;
+            ln->rec  = QSPY_output.rec;
+            ln->type = QSPY_output.type;
+            ln->len  = QSPY_output.len;
+            ln->line = line;
+        }
+    }
+    else {
+        ++me->nLost;
+    }
+    QSPY_output.type = REG_OUT; // the line has been consumed
+}
+//............................................................................
+// copy the decoded record to the batch, together with the strings and
+// memory blocks it points to (which live only until the next record)
+static void QSpyBatch_putRec(QSpyBatch * const me,
+                             QSpyRecData const *data)
+{
+    if ((me->recs == (QSpyRecData *)0) || (me->nRecs >= me->maxRecs)) {
+        return;
+    }
+    QSpyRecData *rec = &me->recs[me->nRecs];
+    ++me->nRecs;
+    *rec = *data;
+    for (uint8_t i = 0U; i < rec->nFld; ++i) {
+        QSpyField *fld = &rec->fld[i];
+        // the fields that do not fit into text[] are stored empty
+        if (fld->type == QSPY_FLD_STR) {
+            fld->val.str = QSpyBatch_putText(me, fld->val.str,
+                               (uint32_t)strlen(fld->val.str));
+            if (fld->val.str == (char const *)0) {
+                fld->val.str = "";
+            }
+        }
+        else if (fld->type == QSPY_FLD_MEM) {
+            fld->val.mem = (uint8_t const *)QSpyBatch_putText(me,
+                               fld->val.mem, (uint32_t)fld->num * fld->size);
+            if (fld->val.mem == (uint8_t const *)0) {
+                fld->val.mem = (uint8_t const *)"";
+                fld->num = 0U;
+            }
+        }
+    }
+}
+//............................................................................
+// is there no room in the batch for another record?
+static bool QSpyBatch_isFull(QSpyBatch const * const me) {
+    if ((me->lines != (QSpyBatchLine *)0)
+        && (me->nLines + QSPY_BATCH_REC_LINES > me->maxLines))
+    {
+        return true;
+    }
+    if ((me->text != (char *)0)
+        && (me->textLen + QSPY_BATCH_REC_TEXT > me->textSize))
+    {
+        return true;
+    }
+    return (me->recs != (QSpyRecData *)0) && (me->nRecs >= me->maxRecs);
+}
+
+//............................................................................
+// update the rolling rates at the end of every QSPY_STATS_PERIOD
+static void QSpyStats_update(QSpyStats * const me, uint64_t now) {
+    uint64_t const dt  = now - me->periodBeg;
+    if (dt < QSPY_STATS_PERIOD) {
+        return;
+    }
+    uint32_t const byteRate = (uint32_t)((me->nBytes - me->periodBytes)
+                                         * 1000U / dt);
+    uint32_t const recRate  = (uint32_t)((me->nRecs - me->periodRecs)
+                                         * 1000U / dt);
+    if (dt < 2U*QSPY_STATS_PERIOD) { // regular period?
+        // exponential moving average (1/4 weight of the last period)
+        me->byteRate = me->byteRate - (me->byteRate >> 2U) + (byteRate >> 2U);
+        me->recRate  = me->recRate  - (me->recRate  >> 2U) + (recRate  >> 2U);
+    }
+    else { // the first period or after a pause
+        me->byteRate = byteRate;
+        me->recRate  = recRate;
+    }
+    me->periodBeg   = now;
+    me->periodBytes = me->nBytes;
+    me->periodRecs  = me->nRecs;
+}
+//............................................................................
+QSpyStats const *QSpyParser_getStats(QSpyParser * const me) {
+    QSpyStats_update(&me->stats, QSPY_nowNs() / 1000000U);
+    return &me->stats;
+}
+//............................................................................
+void QSpyParser_resetStats(QSpyParser * const me) {
+    memset(&me->stats, 0, sizeof(me->stats));
+    me->stats.periodBeg = QSPY_nowNs() / 1000000U;
+}
+//............................................................................
+QSpyStats const *QSPY_getStats(void) {
+    return QSpyParser_getStats(QSPY_currParser);
+}
+//............................................................................
+static uint8_t *QSPY_packLE(uint8_t *pos, uint64_t val, uint8_t size) {
+    for (uint8_t i = 0U; i < size; ++i) {
+        *pos++ = (uint8_t)val;
+        val >>= 8U;
+    }
+    return pos;
+}
+//............................................................................
+uint32_t QSpyStats_pack(QSpyStats const * const me,
+                        uint8_t *buf, uint32_t size)
+{
+    uint32_t nIds = 0U;
+    for (uint32_t i = 0U; i < 256U; ++i) {
+        if (me->recCount[i] != 0U) {
+            ++nIds;
+        }
+    }
+    uint32_t const len = 2U*8U + 7U*4U + 2U + nIds*(1U + 8U + 8U);
+    if (len > size) { // no room?
+        return 0U;
+    }
+
+    uint8_t *pos = buf;
+    pos = QSPY_packLE(pos, me->nBytes,     8U);
+    pos = QSPY_packLE(pos, me->nRecs,      8U);
+    pos = QSPY_packLE(pos, me->nBadChksum, 4U);
+    pos = QSPY_packLE(pos, me->nDiscont,   4U);
+    pos = QSPY_packLE(pos, me->nLost,      4U);
+    pos = QSPY_packLE(pos, me->nTooLong,   4U);
+    pos = QSPY_packLE(pos, me->nTooShort,  4U);
+    pos = QSPY_packLE(pos, me->byteRate,   4U);
+    pos = QSPY_packLE(pos, me->recRate,    4U);
+    pos = QSPY_packLE(pos, nIds,           2U);
+    for (uint32_t i = 0U; i < 256U; ++i) {
+        if (me->recCount[i] != 0U) {
+            *pos++ = (uint8_t)i;
+            pos = QSPY_packLE(pos, me->recCount[i], 8U);
+            pos = QSPY_packLE(pos, me->recBytes[i], 8U);
+        }
+    }
+    return (uint32_t)(pos - buf);
+}
+
+//............................................................................
+// process a healthy (un-escaped and checksum-verified) record
+static void QSpyParser_dispatch(QSpyParser * const me,
+                                uint8_t const *rec, uint32_t len)
+{
+    QSpyRecord qrec;
+    int parse = 1;
+    ++me->seq; // increment with natural wrap-around
+
+    if (!me->isJustStarted) {
+        // data discontinuity found?
+        // but not for the QS_EMPTY record?
+
+        if ((me->seq != rec[0]) && (rec[1] != QS_EMPTY)) {
+            ++me->stats.nDiscont;
+            me->stats.nLost += (uint8_t)(rec[0] - me->seq);
+            SNPRINTF_LINE("   <COMMS> ERROR    Discontinuity "
+                "Seq=%u->%u",
+                (unsigned)(me->seq - 1),
+                (unsigned)rec[0]);
+            QSPY_printError();
+        }
+    }
+    else {
+        me->isJustStarted = false;
+    }
+    me->seq = rec[0];
+
+    ++me->stats.nRecs;
+    ++me->stats.recCount[rec[1]];
+    me->stats.recBytes[rec[1]] += len;
+
+    QSpyRecord_init(&qrec, rec, len);
+
+    if (me->custParseFun != (QSPY_CustParseFun)0) {
+        parse = (*me->custParseFun)(&qrec);
+        if (parse) {
+            // re-initialize the record for parsing again
+            QSpyRecord_init(&qrec, rec, len);
+        }
+    }
+    if (parse) {
+        if (qrec.rec < QS_USER) {
+            // without any output, records with a schema are just decoded
+            if (!(QSPY_isHeadless() && QSpyRecord_decode(&qrec))) {
+                QSpyRecord_process(&qrec);
+            }
+        }
+        else {
+            QSpyRecord_processUser(&qrec);
+        }
+        if (me->onRecordFun != (QSPY_RecordFun)0) {
+            (*me->onRecordFun)(&me->recData);
+        }
+        if (me->batch != (QSpyBatch *)0) {
+            QSpyBatch_putRec(me->batch, &me->recData);
+        }
+    }
+}
+// parse the frames from the buffer until it is exhausted or until
+// the batch (if any) is full. Returns the number of bytes consumed.
+static uint32_t QSpyParser_parseFrames(QSpyParser * const me,
+                                       uint8_t const *buf, uint32_t nBytes)
+{
+    uint8_t const * const start = buf;
+
+    while (nBytes != 0U) {
+        // zero-copy path: a complete record without escapes in the buffer
+        // is processed in place (not copied into me->record[])
+        if ((me->pos == me->record) && (me->esc == 0U)) {
+            uint32_t n = (nBytes > me->recordSize)
+                         ? me->recordSize : nBytes;
+            n = QSPY_findDelim(buf, n);
+            if ((n < nBytes) && (buf[n] == QS_FRAME) && (n >= 3U)
+                && ((uint8_t)(me->chksum + QSPY_sum(buf, n))
+                    == QS_GOOD_CHKSUM))
+            {
+                QSpyParser_dispatch(me, buf, n);
+                // keep the header for the diagnostics of a following
+                // short (corrupted) frame, as if the record was copied
+                me->record[0] = buf[0];
+                me->record[1] = buf[1];
+                me->chksum = 0U;
+                buf    += n + 1U;
+                nBytes -= n + 1U;
 
-    for (; nBytes != 0U; --nBytes) {
+                // no room in the batch for another record?
+                if ((me->batch != (QSpyBatch *)0)
+                    && QSpyBatch_isFull(me->batch))
+                {
+                    break; // stop at this frame boundary
+                }
+                continue;
+            }
+            // otherwise, the record is assembled in me->record[] below
+        }
+
+        // bulk path: move a run of un-escaped bytes in one step
+        if (me->esc == 0U) {
+            uint32_t n = (uint32_t)(&me->record[me->recordSize]
+                                    - me->pos);
+            if (n > nBytes) {
+                n = nBytes;
+            }
+            n = QSPY_findDelim(buf, n);
+            if (n != 0U) {
+                me->chksum = (uint8_t)(me->chksum
+                                       + QSPY_copySum(me->pos, buf, n));
+                me->pos += n;
+                buf     += n;
+                nBytes  -= n;
+                if (nBytes == 0U) {
+                    break;
+                }
+            }
+        }
+
+        // byte-at-a-time path (delimiters, escapes and errors)
         uint8_t b = *buf++;
+        --nBytes;
 
-        if (l_esc) { // escaped byte arrived?
-            l_esc = 0U;
+        if (me->esc) { // escaped byte arrived?
+            me->esc = 0U;
             b ^= QS_ESC_XOR;
 
-            l_chksum = (uint8_t)(l_chksum + b);
-            if (l_pos < &l_record[sizeof(l_record)]) {
-                *l_pos++ = b;
+            me->chksum = (uint8_t)(me->chksum + b);
+            if (me->pos < &me->record[me->recordSize]) {
+                *me->pos++ = b;
             }
             else {
+                ++me->stats.nTooLong;
                 SNPRINTF_LINE("   <COMMS> ERROR    Record too long at "
-                           "Seq=%u(?),", (unsigned)l_seq);
+                           "Seq=%u(?),", (unsigned)me->seq);
                 // is it a standard QS record?
-                if (l_record[1] < QS_USER) {
+                if (me->record[1] < QS_USER) {
                     SNPRINTF_APPEND("Rec=%s(?)",
-                                    l_recRender[l_record[1]].name);
+                                    l_recRender[me->record[1]].name);
                 }
                 else { // this is a USER-specific record
                     SNPRINTF_APPEND("Rec=USER+%u(?)",
-                               (unsigned)(l_record[1] - QS_USER));
+                               (unsigned)(me->record[1] - QS_USER));
                 }
                 QSPY_printError();
-                l_chksum = 0U;
-                l_pos = l_record;
-                l_esc = 0U;
+                me->chksum = 0U;
+                me->pos = me->record;
+                me->esc = 0U;
             }
         }
         else if (b == QS_ESC) {   // transparent byte?
-            l_esc = 1U;
+            me->esc = 1U;
         }
         else if (b == QS_FRAME) { // frame byte?
-            if (l_chksum != QS_GOOD_CHKSUM) { // bad checksum?
-                if (!isJustStarted) {
+            if (me->chksum != QS_GOOD_CHKSUM) { // bad checksum?
+                if (!me->isJustStarted) {
+                    ++me->stats.nBadChksum;
                     SNPRINTF_LINE("   <COMMS> ERROR    %s",
                                   "Bad checksum in ");
-                    if (l_record[1] < QS_USER) {
+                    if (me->record[1] < QS_USER) {
                         SNPRINTF_APPEND("Rec=%s(?),",
-                            l_recRender[l_record[1]].name);
+                            l_recRender[me->record[1]].name);
                     }
                     else {
                         SNPRINTF_APPEND("Rec=USER+%u(?),",
-                            (unsigned)(l_record[1] - QS_USER));
+                            (unsigned)(me->record[1] - QS_USER));
                     }
-                    SNPRINTF_APPEND("Seq=%u", (unsigned)l_seq);
+                    SNPRINTF_APPEND("Seq=%u", (unsigned)me->seq);
                     QSPY_printError();
                 }
             }
-            else if (l_pos < &l_record[3]) { // record too short?
+            else if (me->pos < &me->record[3]) { // record too short?
+                ++me->stats.nTooShort;
                 SNPRINTF_LINE("   <COMMS> ERROR    Record too short at "
                            "Seq=%u(?),",
-                           (unsigned)l_seq);
-                if (l_record[1] < QS_USER) {
-                    SNPRINTF_APPEND("Rec=%s", l_recRender[l_record[1]].name);
+                           (unsigned)me->seq);
+                if (me->record[1] < QS_USER) {
+                    SNPRINTF_APPEND("Rec=%s",
+                                    l_recRender[me->record[1]].name);
                 }
                 else {
                     SNPRINTF_APPEND("Rec=USER+%u(?)",
-                               (unsigned)(l_record[1] - QS_USER));
+                               (unsigned)(me->record[1] - QS_USER));
                 }
                 QSPY_printError();
             }
             else { // a healthy record received
-                QSpyRecord qrec;
-                int parse = 1;
-                ++l_seq; // increment with natural wrap-around
-
-                if (!isJustStarted) {
-                    // data discontinuity found?
-                    // but not for the QS_EMPTY record?
-
-                    if ((l_seq != l_record[0])
-                         && (l_record[1] != QS_EMPTY))
-                    {
-                        SNPRINTF_LINE("   <COMMS> ERROR    Discontinuity "
-                            "Seq=%u->%u",
-                            (unsigned)(l_seq - 1), (unsigned)l_record[0]);
-                        QSPY_printError();
-                    }
-                }
-                else {
-                    isJustStarted = false;
-                }
-                l_seq = l_record[0];
-
-                QSpyRecord_init(&qrec, l_record, (int32_t)(l_pos - l_record));
-
-                if (l_custParseFun != (QSPY_CustParseFun)0) {
-                    parse = (*l_custParseFun)(&qrec);
-                    if (parse) {
-                        // re-initialize the record for parsing again
-                        QSpyRecord_init(&qrec,
-                            l_record, (int32_t)(l_pos - l_record));
-                    }
-                }
-                if (parse) {
-                    if (qrec.rec < QS_USER) {
-                        QSpyRecord_process(&qrec);
-                    }
-                    else {
-                        QSpyRecord_processUser(&qrec);
-                    }
-                }
+                QSpyParser_dispatch(me, me->record,
+                                    (uint32_t)(me->pos - me->record));
             }
 
             // get ready for the next record ...
-            l_chksum = 0U;
-            l_pos = l_record;
-            l_esc = 0U;
+            me->chksum = 0U;
+            me->pos = me->record;
+            me->esc = 0U;
+
+            // no room in the batch for another record?
+            if ((me->batch != (QSpyBatch *)0)
+                && QSpyBatch_isFull(me->batch))
+            {
+                break; // stop at this frame boundary
+            }
         }
         else {  // a regular un-escaped byte
-            l_chksum = (uint8_t)(l_chksum + b);
-            if (l_pos < &l_record[sizeof(l_record)]) {
-                *l_pos++ = b;
+            me->chksum = (uint8_t)(me->chksum + b);
+            if (me->pos < &me->record[me->recordSize]) {
+                *me->pos++ = b;
             }
             else {
+                ++me->stats.nTooLong;
                 SNPRINTF_LINE("   <COMMS> ERROR    Record too long at "
                            "Seq=%3u,",
-                           (unsigned)l_seq);
-                if (l_record[1] < QS_USER) {
-                    SNPRINTF_APPEND("Rec=%s", l_recRender[l_record[1]].name);
+                           (unsigned)me->seq);
+                if (me->record[1] < QS_USER) {
+                    SNPRINTF_APPEND("Rec=%s",
+                                    l_recRender[me->record[1]].name);
                 }
                 else {
                     SNPRINTF_APPEND("Rec=USER+%3u",
-                               (unsigned)(l_record[1] - QS_USER));
+                               (unsigned)(me->record[1] - QS_USER));
                 }
                 QSPY_printError();
-                l_chksum = 0U;
-                l_pos = l_record;
-                l_esc = 0U;
+                me->chksum = 0U;
+                me->pos = me->record;
+                me->esc = 0U;
             }
         }
     }
+    me->stats.nBytes += (uint64_t)(buf - start);
+    uint64_t const now = QSPY_nowNs(); // host time of the reception
+    QSpyStats_update(&me->stats, now / 1000000U);
+    if (me->clock.sample) {
+        QSpyClock_sample(&me->clock, now);
+    }
+    return (uint32_t)(buf - start);
+}
+//............................................................................
+void QSpyParser_parse(QSpyParser * const me,
+                      uint8_t const *buf, uint32_t nBytes)
+{
+    // make this parser current for the processing of the records
+    QSpyParser * const prev = QSPY_currParser;
+    QSPY_currParser = me;
+
+    (void)QSpyParser_parseFrames(me, buf, nBytes);
+
+    QSPY_currParser = prev;
+}
+//............................................................................
+uint32_t QSPY_parseBatch(QSpyBatch * const batch,
+                         uint8_t const *buf, uint32_t nBytes)
+{
+    return QSpyParser_parseBatch(QSPY_currParser, batch, buf, nBytes);
+}
+//............................................................................
+uint32_t QSpyParser_parseBatch(QSpyParser * const me,
+                               QSpyBatch * const batch,
+                               uint8_t const *buf, uint32_t nBytes)
+{
+    QSpyParser * const prev = QSPY_currParser;
+    QSPY_currParser = me;
+
+    // redirect the output to the batch for the duration of the call
+    QSPY_PrintLnFun const printLnFun = me->printLnFun;
+    bool const textOn = me->textOn;
+    me->printLnFun = &QSpyBatch_printLn;
+    me->textOn     = textOn && (batch->lines != (QSpyBatchLine *)0);
+    me->batch      = batch;
+
+    uint32_t n = QSpyParser_parseFrames(me, buf, nBytes);
+
+    me->batch      = (QSpyBatch *)0;
+    me->textOn     = textOn;
+    me->printLnFun = printLnFun;
+
+    QSPY_currParser = prev;
+    return n;
 }
 
 //............................................................................
@@ -2308,15 +3777,41 @@ void QSPY_resetAllDictionaries(void) {
     SigDictionary_reset(&QSPY_sigDict);
 
 #ifdef QSPY_APP
-    QSEQ_dictionaryReset();
-    // find out if NULL needs to be added to the Sequence dictionary...
-    QSEQ_updateDictionary("NULL", 0);
+    if (QSPY_IS_HOST()) {
+        QSEQ_dictionaryReset();
+        // find out if NULL needs to be added to the Sequence dictionary...
+        QSEQ_updateDictionary("NULL", 0);
+    }
 #endif
 
     // pre-fill known user entries
     Dictionary_put(&QSPY_usrDict, 124, "QUTEST_ON_POST");
 }
 //............................................................................
+// NOTE: the dictionaries keep the entries in the order of insertion, so
+// they are sorted by the keys before writing them (QSPY_writeDict()),
+// to keep the dictionary files in the same (sorted) order as before
+void QSPY_sortAllDictionaries(void) {
+    Dictionary_sort(&QSPY_funDict);
+    Dictionary_sort(&QSPY_objDict);
+    Dictionary_sort(&QSPY_usrDict);
+    SigDictionary_sort(&QSPY_sigDict);
+    for (unsigned i = 0U; i < QSPY_ENUM_GROUPS; ++i) {
+        Dictionary_sort(&QSPY_enumDict[i]);
+    }
+}
+//............................................................................
+uint32_t QSPY_getDictDropped(void) {
+    uint32_t dropped = QSPY_funDict.dropped
+                       + QSPY_objDict.dropped
+                       + QSPY_usrDict.dropped
+                       + QSPY_sigDict.dropped;
+    for (unsigned i = 0U; i < QSPY_ENUM_GROUPS; ++i) {
+        dropped += QSPY_enumDict[i].dropped;
+    }
+    return dropped;
+}
+//............................................................................
 SigType QSPY_findSig(char const* name, ObjType obj) {
     return SigDictionary_findSig(&QSPY_sigDict, name, obj);
 }
@@ -2343,30 +3838,217 @@ int QSPY_getGroup(int recId) {
         ? l_recRender[recId].group
         : QS_GRP_UA;
 }
+//............................................................................
+char const *QSPY_getRecName(int recId) {
+    return ((0 <= recId) && (recId < QS_USER)) // is it a Predefined record?
+        ? l_recRender[recId].name
+        : "QS_USER";
+}
 
-// Dictionary class ========================================================*/
-int Dictionary_comp(void const *arg1, void const *arg2) {
-    KeyType key1 = ((DictEntry const *)arg1)->key;
-    KeyType key2 = ((DictEntry const *)arg2)->key;
-    if (key1 > key2) {
-        return 1;
+// Dictionary arena ========================================================*/
+enum {
+    DICT_ARENA_BLOCK  = 16*1024, // size of an arena block [bytes]
+    DICT_INIT_ENTRIES = 64,      // initial capacity of a growable table
+};
+
+struct DictArenaBlock {
+    DictArenaBlock *next;
+    char buf[DICT_ARENA_BLOCK];
+};
+
+//............................................................................
+// copy the name (truncated to QS_DNAME_LEN_MAX-1 chars) into the arena
+// returns the copy or NULL if the arena cannot grow
+static char const *DictArena_put(DictArena * const me, char const *name) {
+    uint32_t len = 0U;
+    while ((len < QS_DNAME_LEN_MAX - 1U) && (name[len] != '\0')) {
+        ++len;
     }
-    else if (key1 < key2) {
-        return -1;
+    if ((me->blocks == (DictArenaBlock *)0)
+        || (me->used + len + 1U > DICT_ARENA_BLOCK))
+    {
+        DictArenaBlock *blk = (DictArenaBlock *)malloc(sizeof(DictArenaBlock));
+        if (blk == (DictArenaBlock *)0) {
+            return (char const *)0;
+        }
+        blk->next  = me->blocks;
+        me->blocks = blk;
+        me->used   = 0U;
     }
-    else {
+    char *str = &me->blocks->buf[me->used];
+    memcpy(str, name, len);
+    str[len] = '\0';
+    me->used += len + 1U;
+    return str;
+}
+//............................................................................
+// free all but the first-allocated block and rewind the arena
+static void DictArena_reset(DictArena * const me) {
+    if (me->blocks != (DictArenaBlock *)0) {
+        while (me->blocks->next != (DictArenaBlock *)0) {
+            DictArenaBlock *blk = me->blocks;
+            me->blocks = blk->next;
+            free(blk);
+        }
+    }
+    me->used = 0U;
+}
+//............................................................................
+static void DictArena_xtor(DictArena * const me) {
+    DictArena_reset(me);
+    free(me->blocks);
+    me->blocks = (DictArenaBlock *)0;
+}
+//............................................................................
+// the next capacity of a growable table and the matching index size
+// returns 0 if the table cannot grow any more
+static int Dictionary_nextCapacity(int capacity, int maxCapacity,
+                                   uint32_t *idxSize)
+{
+    int cap = (capacity > 0) ? 2*capacity : DICT_INIT_ENTRIES;
+    if (cap > maxCapacity) {
+        cap = maxCapacity;
+    }
+    if (cap <= capacity) {
         return 0;
     }
+    // the index is a power of 2 and always has empty slots
+    *idxSize = 4U;
+    while (*idxSize < 2U*(uint32_t)cap) {
+        *idxSize <<= 1;
+    }
+    return cap;
 }
 
+// Dictionary class ========================================================*/
+static DictSlot l_noIdx[1]; // empty index of a dictionary without tables
+
 //............................................................................
-void Dictionary_ctor(Dictionary * const me,
-                            DictEntry *sto, uint32_t capacity)
+// hash of a dictionary key (Fibonacci hashing)
+static uint32_t Dictionary_hash(KeyType key) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+//............................................................................
+// hash of a dictionary name (FNV-1a)
+static uint32_t Dictionary_nameHash(char const *name) {
+    uint32_t h = 2166136261U;
+    for (; *name != '\0'; ++name) {
+        h = (h ^ (uint8_t)*name) * 16777619U;
+    }
+    return h;
+}
+//............................................................................
+// add the entry sto[n] to the name index
+static void Dictionary_putName(Dictionary * const me, int n) {
+    uint32_t idxSize = me->idxMask + 1U;
+    if (me->nameUsed >= idxSize - idxSize/4U) { // too many stale slots?
+        // rebuild the name index from the live entries
+        memset(me->nameIdx, 0, idxSize * sizeof(me->nameIdx[0]));
+        me->nameUsed = 0U;
+        for (int k = 0; k < me->entries; ++k) {
+            if (k != n) {
+                Dictionary_putName(me, k);
+            }
+        }
+    }
+    uint32_t i = Dictionary_nameHash(me->sto[n].name) & me->idxMask;
+    while (me->nameIdx[i].gen == me->gen) {
+        i = (i + 1U) & me->idxMask;
+    }
+    me->nameIdx[i].gen = me->gen;
+    me->nameIdx[i].n   = n + 1;
+    ++me->nameUsed;
+}
+//............................................................................
+// add the entry sto[n] to the key index
+static void Dictionary_putKey(Dictionary * const me, int n) {
+    uint32_t i = Dictionary_hash(me->sto[n].key) & me->idxMask;
+    while (me->idx[i].gen == me->gen) {
+        i = (i + 1U) & me->idxMask;
+    }
+    me->idx[i].gen = me->gen;
+    me->idx[i].n   = n + 1;
+}
+//............................................................................
+// intern the name in the arena, reusing an already interned equal name
+static char const *Dictionary_intern(Dictionary * const me,
+                                     char const *name)
 {
-    me->sto      = sto;
-    me->capacity = capacity;
+    uint32_t i = Dictionary_nameHash(name) & me->idxMask;
+    while (me->nameIdx[i].gen == me->gen) {
+        DictEntry const *e = &me->sto[me->nameIdx[i].n - 1];
+        if (strncmp(e->name, name, QS_DNAME_LEN_MAX) == 0) {
+            return e->name;
+        }
+        i = (i + 1U) & me->idxMask;
+    }
+    return DictArena_put(&me->arena, name);
+}
+//............................................................................
+// grow the tables and rebuild the indexes
+static bool Dictionary_grow(Dictionary * const me) {
+    uint32_t idxSize;
+    int cap = Dictionary_nextCapacity(me->capacity, me->maxCapacity,
+                                      &idxSize);
+    if (cap == 0) {
+        return false;
+    }
+    DictEntry *sto = (DictEntry *)realloc(me->sto, cap * sizeof(DictEntry));
+    if (sto == (DictEntry *)0) {
+        return false;
+    }
+    me->sto = sto;
+    // one allocation for both the key index and the name index
+    DictSlot *idx = (DictSlot *)calloc(2U*idxSize, sizeof(DictSlot));
+    if (idx == (DictSlot *)0) {
+        return false;
+    }
+    if (me->idx != l_noIdx) {
+        free(me->idx);
+    }
+    me->idx      = idx;
+    me->nameIdx  = &idx[idxSize];
+    me->idxMask  = idxSize - 1U;
+    me->nameUsed = 0U;
+    me->capacity = cap;
+    for (int k = 0; k < me->entries; ++k) {
+        Dictionary_putKey(me, k);
+        Dictionary_putName(me, k);
+    }
+    return true;
+}
+
+//............................................................................
+void Dictionary_ctor(Dictionary * const me, uint32_t maxCapacity) {
+    me->notFound[0] = '\0';
+    me->sto         = (DictEntry *)0;
+    me->capacity    = 0;
+    me->maxCapacity = (int)maxCapacity;
+    me->entries     = 0;
+    me->keySize     = 4;
+    me->idx         = l_noIdx; // no tables until the first put
+    me->nameIdx     = l_noIdx;
+    me->idxMask     = 0U;
+    me->gen         = 1U; // the calloc'ed (gen==0) slots are empty
+    me->nameUsed    = 0U;
+    me->dropped     = 0U;
+    me->arena.blocks = (DictArenaBlock *)0;
+    me->arena.used   = 0U;
+}
+//............................................................................
+void Dictionary_xtor(Dictionary * const me) {
+    free(me->sto);
+    if ((me->idx != l_noIdx) && (me->idx != (DictSlot *)0)) {
+        free(me->idx);
+    }
+    DictArena_xtor(&me->arena);
+    me->sto      = (DictEntry *)0;
+    me->capacity = 0;
     me->entries  = 0;
-    me->keySize  = 4;
+    me->idx      = l_noIdx;
+    me->nameIdx  = l_noIdx;
+    me->idxMask  = 0U;
+    me->nameUsed = 0U;
 }
 //............................................................................
  void Dictionary_config(Dictionary * const me, int keySize) {
@@ -2385,25 +4067,32 @@ char const *Dictionary_at(Dictionary * const me, unsigned idx) {
 void Dictionary_put(Dictionary * const me,
                            KeyType key, char const *name)
 {
-    int idx = Dictionary_find(me, key);
-    int n = me->entries;
-    char *dst;
-    if (idx >= 0) { // the key found?
-        Q_ASSERT((idx <= n) || (n == 0));
-        dst = me->sto[idx].name;
-        string_copy(dst, sizeof(me->sto[idx].name), name);
-        dst[sizeof(me->sto[idx].name) - 1] = '\0'; // zero-terminate
+    char const *str;
+    int n = Dictionary_find(me, key);
+    if (n >= 0) { // the key found?
+        if (strncmp(me->sto[n].name, name, QS_DNAME_LEN_MAX) != 0) {
+            str = Dictionary_intern(me, name);
+            if (str != (char const *)0) { // renamed?
+                me->sto[n].name = str;
+                Dictionary_putName(me, n);
+            }
+        }
+        return;
     }
-    else if (n < me->capacity - 1) {
-        me->sto[n].key = key;
-        dst = me->sto[n].name;
-        string_copy(dst, sizeof(me->sto[n].name), name);
-        dst[sizeof(me->sto[idx].name) - 1] = '\0'; // zero-terminate
-        ++me->entries;
-        // keep the entries sorted by the key
-        qsort(me->sto, (uint32_t)me->entries, sizeof(me->sto[0]),
-              &Dictionary_comp);
+
+    n = me->entries;
+    if ((n < me->capacity) || Dictionary_grow(me)) {
+        str = Dictionary_intern(me, name);
+        if (str != (char const *)0) {
+            me->sto[n].key  = key;
+            me->sto[n].name = str;
+            ++me->entries;
+            Dictionary_putKey(me, n);
+            Dictionary_putName(me, n);
+            return;
+        }
     }
+    ++me->dropped; // the entry could not be stored
 }
 //............................................................................
 char const *Dictionary_get(Dictionary * const me, KeyType key, char *buf) {
@@ -2417,7 +4106,7 @@ char const *Dictionary_get(Dictionary * const me, KeyType key, char *buf) {
     }
     else { // key not found
         if (buf == 0) { // extra buffer not provided?
-            buf = me->notFound.name; // use the internal location
+            buf = me->notFound; // use the internal location
         }
         // otherwise use the provided buffer...
         if (me->keySize <= 1) {
@@ -2435,95 +4124,241 @@ char const *Dictionary_get(Dictionary * const me, KeyType key, char *buf) {
 }
 //............................................................................
 int Dictionary_find(Dictionary * const me, KeyType key) {
-    // binary search algorithm...
-    int first = 0;
-    int last = me->entries;
-    if (last > 0) { // not empty?
-        while (first <= last) {
-            int mid = (first + last) / 2;
-            if (me->sto[mid].key == key) {
-                return mid;
-            }
-            if (me->sto[mid].key > key) {
-                last = mid - 1;
-            }
-            else {
-                first = mid + 1;
-            }
+    // hash lookup with linear probing...
+    uint32_t i = Dictionary_hash(key) & me->idxMask;
+    while (me->idx[i].gen == me->gen) {
+        int n = me->idx[i].n - 1;
+        if (me->sto[n].key == key) {
+            return n;
         }
+        i = (i + 1U) & me->idxMask;
     }
     return -1; // entry not found
 }
 //............................................................................
 KeyType Dictionary_findKey(Dictionary * const me, char const *name) {
-    // brute-force search algorithm...
-    for (int i = 0; i < me->entries; ++i) {
-        if (strncmp(me->sto[i].name, name, sizeof(me->sto[i].name)) == 0) {
-            return me->sto[i].key;
+    // name-hash lookup with linear probing...
+    uint32_t i = Dictionary_nameHash(name) & me->idxMask;
+    while (me->nameIdx[i].gen == me->gen) {
+        DictEntry const *e = &me->sto[me->nameIdx[i].n - 1];
+        if (strncmp(e->name, name, QS_DNAME_LEN_MAX) == 0) {
+            return e->key;
         }
+        i = (i + 1U) & me->idxMask;
     }
     return KEY_NOT_FOUND;
 }
 //............................................................................
 void Dictionary_reset(Dictionary * const me) {
-    for (int i = 0; i < me->capacity; ++i) {
-        me->sto[i].key = (KeyType)0;
+    if (++me->gen == 0U) { // generation wrap-around?
+        memset(me->idx, 0, (me->idxMask + 1U) * sizeof(me->idx[0]));
+        memset(me->nameIdx, 0, (me->idxMask + 1U) * sizeof(me->nameIdx[0]));
+        me->gen = 1U;
+    }
+    DictArena_reset(&me->arena);
+    me->entries  = 0;
+    me->nameUsed = 0U;
+    me->dropped  = 0U;
+}
+//............................................................................
+static int Dictionary_comp(void const *arg1, void const *arg2) {
+    KeyType key1 = ((DictEntry const *)arg1)->key;
+    KeyType key2 = ((DictEntry const *)arg2)->key;
+    return (key1 > key2) ? 1 : ((key1 < key2) ? -1 : 0);
+}
+//............................................................................
+// sort the entries by the key (the keys are unique) and rebuild the indexes
+void Dictionary_sort(Dictionary * const me) {
+    if (me->entries < 2) {
+        return;
+    }
+    qsort(me->sto, (size_t)me->entries, sizeof(me->sto[0]),
+          &Dictionary_comp);
+    memset(me->idx, 0, 2U*(me->idxMask + 1U) * sizeof(me->idx[0]));
+    me->nameUsed = 0U;
+    for (int k = 0; k < me->entries; ++k) {
+        Dictionary_putKey(me, k);
+        Dictionary_putName(me, k);
     }
-    me->entries = 0;
 }
 
 // SigDictionary class =====================================================*/
-static int SigDictionary_comp(void const *arg1, void const *arg2) {
-    SigType sig1 = ((SigDictEntry const *)arg1)->sig;
-    SigType sig2 = ((SigDictEntry const *)arg2)->sig;
-    if (sig1 > sig2) {
-        return 1;
+// NOTE: the index holds the first entry for each signal, and
+// the other entries with the same signal are chained through 'next'
+static uint32_t SigDictionary_hash(SigType sig) {
+    return (uint32_t)(sig * 0x9E3779B1U);
+}
+//............................................................................
+// add the entry sto[n] to the name index
+static void SigDictionary_putName(SigDictionary * const me, int n) {
+    uint32_t idxSize = me->idxMask + 1U;
+    if (me->nameUsed >= idxSize - idxSize/4U) { // too many stale slots?
+        // rebuild the name index from the live entries
+        memset(me->nameIdx, 0, idxSize * sizeof(me->nameIdx[0]));
+        me->nameUsed = 0U;
+        for (int k = 0; k < me->entries; ++k) {
+            if (k != n) {
+                SigDictionary_putName(me, k);
+            }
+        }
     }
-    else if (sig1 < sig2) {
-        return -1;
+    uint32_t i = Dictionary_nameHash(me->sto[n].name) & me->idxMask;
+    while (me->nameIdx[i].gen == me->gen) {
+        i = (i + 1U) & me->idxMask;
     }
-    else { // sig1 == sig2
-        return 0;
+    me->nameIdx[i].gen = me->gen;
+    me->nameIdx[i].n   = n + 1;
+    ++me->nameUsed;
+}
+//............................................................................
+// add the entry sto[n] to the sig index, at the end of the chain for its sig
+static void SigDictionary_putSig(SigDictionary * const me, int n) {
+    uint32_t i = SigDictionary_hash(me->sto[n].sig) & me->idxMask;
+    me->sto[n].next = 0;
+    while (me->idx[i].gen == me->gen) {
+        int k = me->idx[i].n;
+        if (me->sto[k - 1].sig == me->sto[n].sig) { // the sig found?
+            while (me->sto[k - 1].next != 0) {
+                k = me->sto[k - 1].next;
+            }
+            me->sto[k - 1].next = n + 1;
+            return;
+        }
+        i = (i + 1U) & me->idxMask;
     }
+    me->idx[i].gen = me->gen; // first entry for the sig
+    me->idx[i].n   = n + 1;
 }
 //............................................................................
-void SigDictionary_ctor(SigDictionary * const me,
-                        SigDictEntry *sto, uint32_t capacity)
+// intern the name in the arena, reusing an already interned equal name
+static char const *SigDictionary_intern(SigDictionary * const me,
+                                        char const *name)
 {
-    me->sto      = sto;
-    me->capacity = capacity;
+    uint32_t i = Dictionary_nameHash(name) & me->idxMask;
+    while (me->nameIdx[i].gen == me->gen) {
+        SigDictEntry const *e = &me->sto[me->nameIdx[i].n - 1];
+        if (strncmp(e->name, name, QS_DNAME_LEN_MAX) == 0) {
+            return e->name;
+        }
+        i = (i + 1U) & me->idxMask;
+    }
+    return DictArena_put(&me->arena, name);
+}
+//............................................................................
+// grow the tables and rebuild the indexes
+static bool SigDictionary_grow(SigDictionary * const me) {
+    uint32_t idxSize;
+    int cap = Dictionary_nextCapacity(me->capacity, me->maxCapacity,
+                                      &idxSize);
+    if (cap == 0) {
+        return false;
+    }
+    SigDictEntry *sto = (SigDictEntry *)realloc(me->sto,
+                                                cap * sizeof(SigDictEntry));
+    if (sto == (SigDictEntry *)0) {
+        return false;
+    }
+    me->sto = sto;
+    // one allocation for both the sig index and the name index
+    DictSlot *idx = (DictSlot *)calloc(2U*idxSize, sizeof(DictSlot));
+    if (idx == (DictSlot *)0) {
+        return false;
+    }
+    if (me->idx != l_noIdx) {
+        free(me->idx);
+    }
+    me->idx      = idx;
+    me->nameIdx  = &idx[idxSize];
+    me->idxMask  = idxSize - 1U;
+    me->nameUsed = 0U;
+    me->capacity = cap;
+    for (int k = 0; k < me->entries; ++k) { // preserves the chain order
+        SigDictionary_putSig(me, k);
+        SigDictionary_putName(me, k);
+    }
+    return true;
+}
+//............................................................................
+void SigDictionary_ctor(SigDictionary * const me, uint32_t maxCapacity) {
+    me->notFound[0] = '\0';
+    me->sto         = (SigDictEntry *)0;
+    me->capacity    = 0;
+    me->maxCapacity = (int)maxCapacity;
+    me->entries     = 0;
+    me->ptrSize     = 4;
+    me->idx         = l_noIdx; // no tables until the first put
+    me->nameIdx     = l_noIdx;
+    me->idxMask     = 0U;
+    me->gen         = 1U; // the calloc'ed (gen==0) slots are empty
+    me->nameUsed    = 0U;
+    me->dropped     = 0U;
+    me->arena.blocks = (DictArenaBlock *)0;
+    me->arena.used   = 0U;
+}
+//............................................................................
+void SigDictionary_xtor(SigDictionary * const me) {
+    free(me->sto);
+    if ((me->idx != l_noIdx) && (me->idx != (DictSlot *)0)) {
+        free(me->idx);
+    }
+    DictArena_xtor(&me->arena);
+    me->sto      = (SigDictEntry *)0;
+    me->capacity = 0;
     me->entries  = 0;
-    me->ptrSize  = 4;
+    me->idx      = l_noIdx;
+    me->nameIdx  = l_noIdx;
+    me->idxMask  = 0U;
+    me->nameUsed = 0U;
 }
 //............................................................................
 void SigDictionary_config(SigDictionary * const me, int ptrSize) {
     me->ptrSize = ptrSize;
 }
 //............................................................................
+// NOTE: the entries are keyed by both sig and obj, so an object-specific
+// entry for a sig no longer replaces the global (obj==0) entry for it
+// (or vice versa), but is kept next to it. See also SigDictionary_find().
 void SigDictionary_put(SigDictionary * const me,
                        SigType sig, ObjType obj, char const *name)
 {
-    int idx = SigDictionary_find(me, sig, obj);
+    char const *str;
+    uint32_t i = SigDictionary_hash(sig) & me->idxMask;
+    while (me->idx[i].gen == me->gen) {
+        if (me->sto[me->idx[i].n - 1].sig == sig) { // the sig found?
+            int k = me->idx[i].n;
+            do {
+                SigDictEntry *e = &me->sto[k - 1];
+                if (e->obj == obj) { // the sig/obj found?
+                    if (strncmp(e->name, name, QS_DNAME_LEN_MAX) != 0) {
+                        str = SigDictionary_intern(me, name);
+                        if (str != (char const *)0) { // renamed?
+                            e->name = str;
+                            SigDictionary_putName(me, k - 1);
+                        }
+                    }
+                    return;
+                }
+                k = e->next;
+            } while (k != 0);
+            break;
+        }
+        i = (i + 1U) & me->idxMask;
+    }
+
     int n = me->entries;
-    char *dst;
-    if (idx >= 0) { // the key found?
-        Q_ASSERT((idx <= n) || (n == 0));
-        me->sto[idx].obj = obj;
-        dst = me->sto[idx].name;
-        string_copy(dst, sizeof(me->sto[idx].name), name);
-        dst[sizeof(me->sto[idx].name) - 1] = '\0'; // zero-terminate
-    }
-    else if (n < me->capacity - 1) {
-        me->sto[n].sig = sig;
-        me->sto[n].obj = obj;
-        dst = me->sto[n].name;
-        string_copy(dst, sizeof(me->sto[n].name), name);
-        dst[sizeof(me->sto[idx].name) - 1] = '\0'; // zero-terminate
-        ++me->entries;
-        // keep the entries sorted by the sig
-        qsort(me->sto, (uint32_t)me->entries, sizeof(me->sto[0]),
-              &SigDictionary_comp);
+    if ((n < me->capacity) || SigDictionary_grow(me)) {
+        str = SigDictionary_intern(me, name);
+        if (str != (char const *)0) {
+            me->sto[n].sig  = sig;
+            me->sto[n].obj  = obj;
+            me->sto[n].name = str;
+            ++me->entries;
+            SigDictionary_putSig(me, n);
+            SigDictionary_putName(me, n);
+            return;
+        }
     }
+    ++me->dropped; // the entry could not be stored
 }
 //............................................................................
 char const *SigDictionary_get(SigDictionary * const me,
@@ -2539,7 +4374,7 @@ char const *SigDictionary_get(SigDictionary * const me,
     }
     else { // key not found
         if (buf == 0) { // extra buffer not provided?
-            buf = me->notFound.name; // use the internal location
+            buf = me->notFound; // use the internal location
         }
         // otherwise use the provided buffer...
         if (me->ptrSize <= 4) {
@@ -2555,73 +4390,107 @@ char const *SigDictionary_get(SigDictionary * const me,
     }
 }
 //............................................................................
+// returns the entry for the signal 'sig' specific to the object 'obj'
+// or the global entry for 'sig' (obj==0). A global lookup (obj==0) falls
+// back to any object-specific entry for 'sig'.
 int SigDictionary_find(SigDictionary * const me,
                        SigType sig, ObjType obj)
 {
-    // binary search algorithm ...
-    int mid;
-    int first = 0;
-    int last = me->entries;
-    while (first <= last) {
-        mid = (first + last) / 2;
-        if (me->sto[mid].sig == sig) {
-            if (obj == 0) { // global/generic signal?
-                return mid;
-            }
-            else {
-                first = mid;
-                do {
-                    if ((me->sto[first].obj == 0)
-                        || (me->sto[first].obj == obj))
-                    {
-                        return first;
-                    }
-                    --first;
-                } while ((first >= 0) && (me->sto[first].sig == sig));
-                last = mid + 1;
-                while ((last < me->entries) && (me->sto[last].sig == sig)) {
-                    if ((me->sto[last].obj == 0)
-                        || (me->sto[last].obj == obj))
-                    {
-                        return last;
-                    }
-                    ++last;
+    // hash lookup with linear probing...
+    uint32_t i = SigDictionary_hash(sig) & me->idxMask;
+    while (me->idx[i].gen == me->gen) {
+        int k = me->idx[i].n;
+        if (me->sto[k - 1].sig == sig) { // the sig found?
+            int glb = -1; // the global entry (obj==0)
+            do {
+                SigDictEntry const *e = &me->sto[k - 1];
+                if (e->obj == obj) {
+                    return k - 1;
                 }
-                return -1;  // entry not found
-            }
-        }
-        if (me->sto[mid].sig > sig) {
-            last = mid - 1;
-        }
-        else {
-            first = mid + 1;
+                if (e->obj == (ObjType)0) {
+                    glb = k - 1;
+                }
+                k = e->next;
+            } while (k != 0);
+            return ((glb >= 0) || (obj != (ObjType)0))
+                   ? glb
+                   : (me->idx[i].n - 1);
         }
+        i = (i + 1U) & me->idxMask;
     }
-
     return -1; // entry not found
 }
 //............................................................................
 SigType SigDictionary_findSig(SigDictionary * const me,
                               char const *name, ObjType obj)
 {
-    // brute-force search algorithm...
-    int i;
-    for (i = 0; i < me->entries; ++i) {
-        if (((me->sto[i].obj == obj) || (me->sto[i].obj == (ObjType)0))
-            && (strncmp(me->sto[i].name, name, sizeof(me->sto[i].name)) == 0))
+    // name-hash lookup with linear probing...
+    uint32_t i = Dictionary_nameHash(name) & me->idxMask;
+    while (me->nameIdx[i].gen == me->gen) {
+        SigDictEntry const *e = &me->sto[me->nameIdx[i].n - 1];
+        if (((e->obj == obj) || (e->obj == (ObjType)0))
+            && (strncmp(e->name, name, QS_DNAME_LEN_MAX) == 0))
         {
-            return me->sto[i].sig;
+            return e->sig;
         }
+        i = (i + 1U) & me->idxMask;
     }
     return (SigType)0; // not found
 }
 //............................................................................
 void SigDictionary_reset(SigDictionary * const me) {
-    int i;
-    for (i = 0; i < me->capacity; ++i) {
-        me->sto[i].sig = (SigType)0;
+    if (++me->gen == 0U) { // generation wrap-around?
+        memset(me->idx, 0, (me->idxMask + 1U) * sizeof(me->idx[0]));
+        memset(me->nameIdx, 0, (me->idxMask + 1U) * sizeof(me->nameIdx[0]));
+        me->gen = 1U;
+    }
+    DictArena_reset(&me->arena);
+    me->entries  = 0;
+    me->nameUsed = 0U;
+    me->dropped  = 0U;
+}
+//............................................................................
+// entry of the SigDictionary with its original position (for stable sort)
+typedef struct {
+    SigDictEntry e;
+    int          n;
+} SigDictSortEntry;
+
+static int SigDictionary_comp(void const *arg1, void const *arg2) {
+    SigDictSortEntry const *e1 = (SigDictSortEntry const *)arg1;
+    SigDictSortEntry const *e2 = (SigDictSortEntry const *)arg2;
+    if (e1->e.sig != e2->e.sig) {
+        return (e1->e.sig > e2->e.sig) ? 1 : -1;
+    }
+    return e1->n - e2->n; // keep the order of the entries with the same sig
+}
+//............................................................................
+// sort the entries by the sig (stable, so that the lookups don't change)
+// and rebuild the indexes
+void SigDictionary_sort(SigDictionary * const me) {
+    if (me->entries < 2) {
+        return;
+    }
+    SigDictSortEntry *tmp = (SigDictSortEntry *)malloc(
+                                (size_t)me->entries * sizeof(*tmp));
+    if (tmp == (SigDictSortEntry *)0) {
+        return; // the dictionary remains usable, just not sorted
+    }
+    for (int k = 0; k < me->entries; ++k) {
+        tmp[k].e = me->sto[k];
+        tmp[k].n = k;
+    }
+    qsort(tmp, (size_t)me->entries, sizeof(tmp[0]), &SigDictionary_comp);
+    for (int k = 0; k < me->entries; ++k) {
+        me->sto[k] = tmp[k].e;
+    }
+    free(tmp);
+    memset(me->idx, 0, 2U*(me->idxMask + 1U) * sizeof(me->idx[0]));
+    me->nameUsed = 0U;
+    for (int k = 0; k < me->entries; ++k) { // preserves the chain order
+        SigDictionary_putSig(me, k);
+        SigDictionary_putName(me, k);
     }
-    me->entries = 0;
 }
 
 //----------------------------------------------------------------------------
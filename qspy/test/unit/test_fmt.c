@@ -0,0 +1,175 @@
+//============================================================================
+// QSPY software tracing host-side utility
+//
+//                   Q u a n t u m  L e a P s
+//                   ------------------------
+//                   Modern Embedded Software
+//
+// Copyright(C) 2005 Quantum Leaps, LLC.All rights reserved.
+//
+// This software is licensed under the terms of the Quantum Leaps
+// QSPY SOFTWARE TRACING HOST UTILITY SOFTWARE END USER LICENSE.
+// Please see the file LICENSE-qspy.txt for the complete license text.
+//
+// Quantum Leaps contact information :
+// <www.state-machine.com/licensing>
+// <info@state-machine.com>
+//============================================================================
+// regression test of the fast formatters (QSPY_appendDec/Int/Hex/Uns/Mem)
+// against the printf() formats they replace. The output must be identical
+// byte for byte, because QUTest expect() matches the lines exactly.
+//
+// NOTE: the formatters are static, so the test includes qspy.c directly
+
+#include "../../source/qspy.c"
+
+//............................................................................
+void QSPY_onPrintLn(void) {
+}
+//............................................................................
+_Noreturn void Q_onError(char const * const module, int const id) {
+    PRINTF_S("ASSERTION in %s:%d\n", module, id);
+    exit(-1);
+}
+
+// the printf() formats of the user records (QSpyRecord_processUser())
+static char const * const l_ifmt[] = {
+    "%li",   "%1li",  "%2li",  "%3li",
+    "%4li",  "%5li",  "%6li",  "%7li",
+    "%8li",  "%9li",  "%10li", "%11li",
+    "%12li", "%13li", "%14li", "%15li"
+};
+static char const * const l_ufmt[] = {
+    "%lu",   "%1lu",  "%2lu",  "%3lu",
+    "%4lu",  "%5lu",  "%6lu",  "%7lu",
+    "%8lu",  "%9lu",  "%10lu", "%11lu",
+    "%12lu", "%13lu", "%14lu", "%15lu"
+};
+static char const * const l_uhfmt[] = {
+    "0x%0lX",   "0x%01lX",  "0x%02lX",  "0x%03lX",
+    "0x%04lX",  "0x%05lX",  "0x%06lX",  "0x%07lX",
+    "0x%08lX",  "0x%09lX",  "0x%010lX", "0x%011lX",
+    "0x%012lX", "0x%013lX", "0x%014lX", "0x%015lX"
+};
+static char const * const l_ilfmt[] = {
+    "%2"PRIi64,  "%4"PRIi64,  "%6"PRIi64,  "%8"PRIi64,
+    "%10"PRIi64, "%12"PRIi64, "%14"PRIi64, "%16"PRIi64,
+    "%18"PRIi64, "%"PRIi64,   "%22"PRIi64, "%24"PRIi64, // NOTE: [9] unpadded
+    "%26"PRIi64, "%28"PRIi64, "%30"PRIi64, "%32"PRIi64
+};
+static char const * const l_ulfmt[] = {
+    "%2"PRIu64,  "%4"PRIu64,  "%6"PRIu64,  "%8"PRIu64,
+    "%10"PRIu64, "%12"PRIu64, "%14"PRIu64, "%16"PRIu64,
+    "%18"PRIu64, "%20"PRIu64, "%22"PRIu64, "%24"PRIu64,
+    "%26"PRIu64, "%28"PRIu64, "%30"PRIu64, "%32"PRIu64
+};
+
+static char     l_ref[512];
+static uint32_t l_nFail;
+
+//............................................................................
+static void check(char const *what, unsigned width, uint64_t val) {
+    if ((strcmp(QSPY_line, l_ref) != 0)
+        || (QSPY_output.len != (int)strlen(l_ref)))
+    {
+        if (l_nFail < 10U) {
+            PRINTF_S("FAIL %s width=%u val=0x%016"PRIX64": \"%s\" != \"%s\"\n",
+                     what, width, val, QSPY_line, l_ref);
+        }
+        ++l_nFail;
+    }
+    QSPY_output.len = 0;
+    QSPY_line[0] = '\0';
+}
+//............................................................................
+static uint64_t rnd(void) { // xorshift64
+    static uint64_t x = 88172645463325252ULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+//............................................................................
+int main(void) {
+    static uint64_t const specials[] = {
+        0U, 1U, 9U, 10U, 99U, 100U, 101U, 999U, 1000U, 65535U,
+        0x7FFFFFFFU, 0x80000000U, 0xFFFFFFFFU,
+        0x7FFFFFFFFFFFFFFFULL, 0x8000000000000000ULL,
+        0xFFFFFFFFFFFFFFFFULL, 12345678901234567890ULL
+    };
+    uint32_t const nSpecials = sizeof(specials)/sizeof(specials[0]);
+    uint32_t nTests = 0U;
+
+    QSPY_parser.textOn = true;
+    QSPY_output.len = 0;
+
+    for (uint32_t it = 0U; it < 200000U; ++it) {
+        // the special values at every width, then random magnitudes
+        uint64_t const v = (it < 16U*nSpecials)
+                           ? specials[it / 16U]
+                           : (rnd() >> (rnd() % 64U));
+        unsigned const w = it % 16U;
+        int32_t  const i32 = (int32_t)(uint32_t)v;
+        uint32_t const u32 = (uint32_t)v;
+        int64_t  const i64 = (int64_t)v;
+
+        QSPY_appendInt(i32, w);
+        SNPRINTF_S(l_ref, sizeof(l_ref), l_ifmt[w], (long)i32);
+        check("ifmt", w, v);
+
+        QSPY_appendInt((int8_t)v, w); // sign-extended 1-byte value
+        SNPRINTF_S(l_ref, sizeof(l_ref), l_ifmt[w], (long)(int8_t)v);
+        check("ifmt(i8)", w, v);
+
+        QSPY_appendUns(u32, w, false, 0U);
+        SNPRINTF_S(l_ref, sizeof(l_ref), l_ufmt[w], (unsigned long)u32);
+        check("ufmt", w, v);
+
+        QSPY_appendUns(u32, w, true, w);
+        SNPRINTF_S(l_ref, sizeof(l_ref), l_uhfmt[w], (unsigned long)u32);
+        check("uhfmt", w, v);
+
+        QSPY_appendInt(i64, (w != 9U) ? 2U*(w + 1U) : 0U);
+        SNPRINTF_S(l_ref, sizeof(l_ref), l_ilfmt[w], i64);
+        check("ilfmt", w, v);
+
+        QSPY_appendDec(v, false, 2U*(w + 1U), ' ');
+        SNPRINTF_S(l_ref, sizeof(l_ref), l_ulfmt[w], v);
+        check("ulfmt", w, v);
+
+        QSPY_appendStr("0x", 2);
+        QSPY_appendHex(v, 16U, ' '); // space-padded 64-bit hex
+        SNPRINTF_S(l_ref, sizeof(l_ref), "0x%16"PRIX64, v);
+        check("0x%16X", w, v);
+
+        QSPY_appendDec(u32, false, 10U, '0'); // the timestamps
+        SNPRINTF_S(l_ref, sizeof(l_ref), "%010u", (unsigned)u32);
+        check("%010u", w, v);
+
+        QSPY_appendDec(u32 & 0x7FU, false, 3U, '0'); // the user record-IDs
+        SNPRINTF_S(l_ref, sizeof(l_ref), "%03d", (int)(u32 & 0x7FU));
+        check("%03d", w, v);
+
+        // the memory dumps of 0..255 bytes
+        uint8_t mem[256];
+        uint32_t const num = (uint32_t)(rnd() % 256U);
+        l_ref[0] = '\0';
+        for (uint32_t k = 0U; k < num; ++k) {
+            mem[k] = (uint8_t)rnd();
+        }
+        QSPY_appendMem(mem, num);
+        for (uint32_t k = 0U; (k < num) && (k < 160U); ++k) {
+            SNPRINTF_S(&l_ref[3U*k], 4U, " %02X", (unsigned)mem[k]);
+        }
+        if (num <= 160U) { // the reference fits l_ref[]
+            check("mem", num, v);
+        }
+        QSPY_output.len = 0;
+
+        nTests += 10U;
+    }
+
+    PRINTF_S("test_fmt: %u checks, %u failures\n",
+             (unsigned)nTests, (unsigned)l_nFail);
+    return (l_nFail == 0U) ? 0 : 1;
+}
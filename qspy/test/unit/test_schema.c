@@ -0,0 +1,301 @@
+//============================================================================
+// QSPY software tracing host-side utility
+//
+//                   Q u a n t u m  L e a P s
+//                   ------------------------
+//                   Modern Embedded Software
+//
+// Copyright(C) 2005 Quantum Leaps, LLC.All rights reserved.
+//
+// This software is licensed under the terms of the Quantum Leaps
+// QSPY SOFTWARE TRACING HOST UTILITY SOFTWARE END USER LICENSE.
+// Please see the file LICENSE-qspy.txt for the complete license text.
+//
+// Quantum Leaps contact information :
+// <www.state-machine.com/licensing>
+// <info@state-machine.com>
+//============================================================================
+// regression test of the table-driven decoder (l_recSchema[] and
+// QSpyRecord_decode()) against QSpyRecord_process(). Every capture is
+// decoded with the text output on (the records go through the switch in
+// QSpyRecord_process()) and off (the records with a schema go through
+// QSpyRecord_decode()), and the decoded QSpyRecData must be identical
+// record by record. The same comparison covers the plans of the user
+// records (QSpyUsrPlan) on a synthetic stream of user records with random
+// formats, format-signature changes, strings, memory blocks and
+// truncated records.
+//
+// NOTE: the decoders are static, so the test includes qspy.c directly
+
+#include "../../source/qspy.c"
+
+//............................................................................
+void QSPY_onPrintLn(void) {
+}
+//............................................................................
+_Noreturn void Q_onError(char const * const module, int const id) {
+    PRINTF_S("ASSERTION in %s:%d\n", module, id);
+    exit(-1);
+}
+
+// the decoded records serialized one after another
+typedef struct {
+    uint8_t *buf;
+    size_t   len;
+    size_t   size;
+    size_t   pos;    // position of the comparison
+    uint32_t nRecs;
+    uint32_t nFail;
+} RecLog;
+
+static RecLog  l_log;
+static bool    l_compare; // compare with l_log (or just log the records)
+static uint8_t l_rec[8192];
+
+//............................................................................
+static size_t put(size_t len, void const *src, size_t n) {
+    if (len + n <= sizeof(l_rec)) {
+        memcpy(&l_rec[len], src, n);
+    }
+    return len + n;
+}
+//............................................................................
+// serialize the record with the contents of the strings and memory blocks
+static size_t serialize(QSpyRecData const *data) {
+    size_t len = 0U;
+    len = put(len, &data->rec,       sizeof(data->rec));
+    len = put(len, &data->seq,       sizeof(data->seq));
+    len = put(len, &data->hasTstamp, sizeof(data->hasTstamp));
+    len = put(len, &data->nFld,      sizeof(data->nFld));
+    if (data->hasTstamp) {
+        len = put(len, &data->tstamp,   sizeof(data->tstamp));
+        len = put(len, &data->tstamp64, sizeof(data->tstamp64));
+    }
+    uint8_t const nFld = (data->nFld < QSPY_REC_FIELDS_MAX)
+                         ? data->nFld : QSPY_REC_FIELDS_MAX;
+    for (uint8_t i = 0U; i < nFld; ++i) {
+        QSpyField const *fld = &data->fld[i];
+        len = put(len, &fld->type, sizeof(fld->type));
+        len = put(len, &fld->size, sizeof(fld->size));
+        switch (fld->type) {
+            case QSPY_FLD_STR:
+                len = put(len, fld->val.str, strlen(fld->val.str) + 1U);
+                break;
+            case QSPY_FLD_MEM:
+                len = put(len, &fld->num, sizeof(fld->num));
+                len = put(len, fld->val.mem,
+                          (size_t)fld->num * fld->size);
+                break;
+            default:
+                len = put(len, &fld->val.u, sizeof(fld->val.u));
+                break;
+        }
+    }
+    Q_ASSERT(len <= sizeof(l_rec));
+    return len;
+}
+//............................................................................
+static void onRecord(QSpyRecData const *data) {
+    size_t const len = serialize(data);
+    if (!l_compare) {
+        if (l_log.len + len > l_log.size) {
+            l_log.size = (l_log.size > 0U) ? 2U*l_log.size : 1024U*1024U;
+            l_log.buf  = (uint8_t *)realloc(l_log.buf, l_log.size);
+            Q_ASSERT(l_log.buf != (uint8_t *)0);
+        }
+        memcpy(&l_log.buf[l_log.len], l_rec, len);
+        l_log.len += len;
+    }
+    else {
+        if ((l_log.pos + len > l_log.len)
+            || (memcmp(&l_log.buf[l_log.pos], l_rec, len) != 0))
+        {
+            if (l_log.nFail < 10U) {
+                PRINTF_S("FAIL record #%u (rec=%u, seq=%u)\n",
+                         (unsigned)l_log.nRecs,
+                         (unsigned)data->rec, (unsigned)data->seq);
+            }
+            ++l_log.nFail;
+        }
+        l_log.pos += len; // stays in sync, because the records are
+                          // logged in the same order
+    }
+    ++l_log.nRecs;
+}
+//............................................................................
+static void decode(uint8_t const *buf, size_t nBytes, bool textOn) {
+    static QSpyParser parser;
+    QSpyConfig conf;
+    memset(&conf, 0, sizeof(conf));
+    conf.qpVersion    = 810U;
+    conf.objPtrSize   = 4U;
+    conf.funPtrSize   = 4U;
+    conf.tstampSize   = 4U;
+    conf.sigSize      = 2U;
+    conf.evtSize      = 2U;
+    conf.queueCtrSize = 1U;
+    conf.poolCtrSize  = 2U;
+    conf.poolBlkSize  = 2U;
+    conf.tevtCtrSize  = 2U;
+
+    QSpyParser_init(&parser, &conf, (QSPY_CustParseFun)0);
+    parser.textOn      = textOn;
+    parser.onRecordFun = &onRecord;
+
+    // feed the capture in pieces, to exercise also the copying path
+    for (size_t off = 0U; off < nBytes; off += 100U) {
+        uint32_t const n = (nBytes - off > 100U)
+                           ? 100U : (uint32_t)(nBytes - off);
+        QSpyParser_parse(&parser, &buf[off], n);
+    }
+    QSpyParser_xtor(&parser);
+}
+//............................................................................
+// decode the buffer with the text on and off, returns the number of fails
+static uint32_t check(char const *name, uint8_t const *buf, size_t nBytes) {
+    memset(&l_log, 0, sizeof(l_log));
+    l_compare = false;
+    decode(buf, nBytes, true);
+    uint32_t const nRecs = l_log.nRecs;
+
+    l_log.nRecs = 0U;
+    l_compare = true;
+    decode(buf, nBytes, false);
+    if ((l_log.nRecs != nRecs) || (l_log.pos != l_log.len)) {
+        PRINTF_S("FAIL %s: %u records with text, %u without\n",
+                 name, (unsigned)nRecs, (unsigned)l_log.nRecs);
+        ++l_log.nFail;
+    }
+    PRINTF_S("test_schema: %s: %u records, %u failures\n",
+             name, (unsigned)nRecs, (unsigned)l_log.nFail);
+    free(l_log.buf);
+    return l_log.nFail;
+}
+//............................................................................
+static uint64_t rnd(void) { // xorshift64
+    static uint64_t x = 88172645463325252ULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+//............................................................................
+// append the framed (escaped) record to the stream buf[], returns the end
+static size_t frame(uint8_t *buf, size_t len,
+                    uint8_t seq, uint8_t rec,
+                    uint8_t const *payload, size_t n)
+{
+    uint8_t chksum = (uint8_t)(seq + rec);
+    for (size_t i = 0U; i < n; ++i) {
+        chksum = (uint8_t)(chksum + payload[i]);
+    }
+    chksum = (uint8_t)~chksum;
+    for (size_t i = 0U; i < n + 3U; ++i) {
+        uint8_t const b = (i == 0U) ? seq
+                        : (i == 1U) ? rec
+                        : (i < n + 2U) ? payload[i - 2U]
+                        : chksum;
+        if ((b == QS_FRAME) || (b == QS_ESC)) {
+            buf[len++] = QS_ESC;
+            buf[len++] = (uint8_t)(b ^ QS_ESC_XOR);
+        }
+        else {
+            buf[len++] = b;
+        }
+    }
+    buf[len++] = QS_FRAME;
+    return len;
+}
+//............................................................................
+// synthetic stream of user records, returns the length of the stream
+static size_t genUsr(uint8_t *buf, size_t size) {
+    // the fixed-size formats and their sizes (ObjPtr=4, FunPtr=4, Sig=2)
+    static uint8_t const fmts[][2] = {
+        { QS_I8_ENUM_FMT, 1U }, { QS_U8_FMT,  1U }, { QS_I16_FMT, 2U },
+        { QS_U16_FMT,     2U }, { QS_I32_FMT, 4U }, { QS_U32_FMT, 4U },
+        { QS_F32_FMT,     4U }, { QS_F64_FMT, 8U }, { QS_SIG_FMT, 6U },
+        { QS_OBJ_FMT,     4U }, { QS_FUN_FMT, 4U }, { QS_I64_FMT, 8U },
+        { QS_U64_FMT,     8U }, { QS_HEX_FMT, 4U }
+    };
+    uint32_t const nFmts = sizeof(fmts)/sizeof(fmts[0]);
+    static uint8_t sig[256][20]; // format signature of every record ID
+    static uint8_t nSig[256];
+    uint8_t payload[300];
+    size_t len = 0U;
+    uint8_t seq = 0U;
+
+    buf[len++] = QS_FRAME;
+    for (unsigned rec = QS_USER; rec < 256U; ++rec) {
+        nSig[rec] = (uint8_t)(rnd() % 21U);
+        for (uint8_t k = 0U; k < nSig[rec]; ++k) {
+            sig[rec][k] = (uint8_t)(rnd() % nFmts);
+        }
+    }
+    while (len + 2U*(sizeof(payload) + 4U) < size) {
+        uint8_t const rec = ((rnd() % 10U) != 0U)
+                            ? (uint8_t)(QS_USER + (rnd() % 40U))
+                            : (uint8_t)(QS_USER + (rnd() % (256U - QS_USER)));
+        uint32_t const r = (uint32_t)(rnd() % 100U);
+        if (r < 3U) { // format-signature change
+            nSig[rec] = (uint8_t)(rnd() % 21U);
+            for (uint8_t k = 0U; k < nSig[rec]; ++k) {
+                sig[rec][k] = (uint8_t)(rnd() % nFmts);
+            }
+        }
+        size_t n = 0U;
+        for (uint8_t k = 0U; k < 4U; ++k) { // timestamp
+            payload[n++] = (uint8_t)rnd();
+        }
+        for (uint8_t k = 0U; k < nSig[rec]; ++k) {
+            uint8_t const *fmt = fmts[sig[rec][k]];
+            payload[n++] = (uint8_t)((rnd() % 16U) << 4) | fmt[0];
+            for (uint8_t j = 0U; j < fmt[1]; ++j) {
+                payload[n++] = (uint8_t)rnd();
+            }
+        }
+        if (r == 97U) { // string
+            payload[n++] = QS_STR_FMT;
+            memcpy(&payload[n], "hello", 6U);
+            n += 6U;
+        }
+        else if (r == 98U) { // memory block
+            uint8_t const num = (uint8_t)(rnd() % 16U);
+            payload[n++] = QS_MEM_FMT;
+            payload[n++] = num;
+            for (uint8_t j = 0U; j < num; ++j) {
+                payload[n++] = (uint8_t)rnd();
+            }
+        }
+        else if ((r == 99U) && (n > 4U)) { // truncated
+            --n;
+        }
+        len = frame(buf, len, ++seq, rec, payload, n);
+    }
+    return len;
+}
+//............................................................................
+int main(void) {
+    static char const * const captures[] = {
+        "../dict/dpp-qpc.bin",
+        "../dict/dpp-qpcpp.bin",
+        "../seq/dpp-qpc.bin",
+        "../seq/dpp-qpcpp.bin",
+    };
+    static uint8_t buf[1024*1024];
+    uint32_t nFail = 0U;
+
+    for (unsigned i = 0U; i < sizeof(captures)/sizeof(captures[0]); ++i) {
+        FILE *f;
+        FOPEN_S(f, captures[i], "rb");
+        if (f == (FILE *)0) {
+            PRINTF_S("FAIL cannot open %s\n", captures[i]);
+            ++nFail;
+            continue;
+        }
+        size_t const n = fread(buf, 1U, sizeof(buf), f);
+        fclose(f);
+        nFail += check(captures[i], buf, n);
+    }
+    nFail += check("user records", buf, genUsr(buf, sizeof(buf)));
+    return (nFail == 0U) ? 0 : 1;
+}
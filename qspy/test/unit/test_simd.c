@@ -0,0 +1,127 @@
+//============================================================================
+// QSPY software tracing host-side utility
+//
+//                   Q u a n t u m  L e a P s
+//                   ------------------------
+//                   Modern Embedded Software
+//
+// Copyright(C) 2005 Quantum Leaps, LLC.All rights reserved.
+//
+// This software is licensed under the terms of the Quantum Leaps
+// QSPY SOFTWARE TRACING HOST UTILITY SOFTWARE END USER LICENSE.
+// Please see the file LICENSE-qspy.txt for the complete license text.
+//
+// Quantum Leaps contact information :
+// <www.state-machine.com/licensing>
+// <info@state-machine.com>
+//============================================================================
+// regression test of the SIMD bulk path of the frame scanner
+// (QSPY_findDelim/QSPY_copySum/QSPY_sum) against the scalar reference,
+// on random buffers of random lengths at random (unaligned) offsets.
+//
+// NOTE: the scanner is static, so the test includes qspy.c directly
+
+#include "../../source/qspy.c"
+
+//............................................................................
+void QSPY_onPrintLn(void) {
+}
+//............................................................................
+_Noreturn void Q_onError(char const * const module, int const id) {
+    PRINTF_S("ASSERTION in %s:%d\n", module, id);
+    exit(-1);
+}
+
+//............................................................................
+static uint64_t rnd(void) { // xorshift64
+    static uint64_t x = 88172645463325252ULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+//............................................................................
+static uint32_t refFindDelim(uint8_t const *buf, uint32_t nBytes) {
+    uint32_t i = 0U;
+    for (; i < nBytes; ++i) {
+        if ((buf[i] == QS_FRAME) || (buf[i] == QS_ESC)) {
+            break;
+        }
+    }
+    return i;
+}
+//............................................................................
+static uint8_t refSum(uint8_t const *src, uint32_t nBytes) {
+    uint8_t sum = 0U;
+    for (uint32_t i = 0U; i < nBytes; ++i) {
+        sum = (uint8_t)(sum + src[i]);
+    }
+    return sum;
+}
+//............................................................................
+int main(void) {
+    static uint8_t buf[4096 + 64];
+    static uint8_t dst[4096 + 64];
+    uint32_t nFail = 0U;
+    uint32_t it = 0U;
+
+    for (; it < 100000U; ++it) {
+        // random contents with the delimiters from dense to absent
+        uint32_t const density = (uint32_t)(rnd() % 8U);
+        for (uint32_t k = 0U; k < sizeof(buf); ++k) {
+            uint8_t b = (uint8_t)rnd();
+            if ((b == QS_FRAME) || (b == QS_ESC)) {
+                b = 0U; // only the delimiters placed below
+            }
+            if ((density > 0U) && ((rnd() % (1U << (3U*density))) == 0U)) {
+                b = ((rnd() & 1U) != 0U) ? QS_FRAME : QS_ESC;
+            }
+            buf[k] = b;
+        }
+        uint32_t const off = (uint32_t)(rnd() % 64U);
+        uint32_t const len = ((it % 4U) == 0U)
+                             ? (uint32_t)(rnd() % 4096U)
+                             : (uint32_t)(rnd() % 100U);
+        uint8_t const * const src = &buf[off];
+
+        uint32_t const n = QSPY_findDelim(src, len);
+        if (n != refFindDelim(src, len)) {
+            PRINTF_S("FAIL findDelim off=%u len=%u: %u != %u\n",
+                     (unsigned)off, (unsigned)len, (unsigned)n,
+                     (unsigned)refFindDelim(src, len));
+            ++nFail;
+        }
+
+        memset(dst, 0xAA, sizeof(dst));
+        uint8_t const dOff = (uint8_t)(rnd() % 16U);
+        uint8_t const sum = QSPY_copySum(&dst[dOff], src, len);
+        if ((sum != refSum(src, len))
+            || (memcmp(&dst[dOff], src, len) != 0)
+            || ((dOff > 0U) && (dst[dOff - 1U] != 0xAAU))
+            || (dst[dOff + len] != 0xAAU))
+        {
+            PRINTF_S("FAIL copySum off=%u len=%u\n",
+                     (unsigned)off, (unsigned)len);
+            ++nFail;
+        }
+        if (QSPY_sum(src, len) != refSum(src, len)) {
+            PRINTF_S("FAIL sum off=%u len=%u\n",
+                     (unsigned)off, (unsigned)len);
+            ++nFail;
+        }
+        if (nFail >= 10U) {
+            break;
+        }
+    }
+
+#if defined(QSPY_SIMD_SSE2)
+    char const * const path = "SSE2";
+#elif defined(QSPY_SIMD_NEON)
+    char const * const path = "NEON";
+#else
+    char const * const path = "scalar only";
+#endif
+    PRINTF_S("test_simd (%s): %u buffers, %u failures\n",
+             path, (unsigned)it, (unsigned)nFail);
+    return (nFail == 0U) ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+@cls
+@rem the "safe" <stdio.h> and <string.h> facilities are in qclean/include
+@set CFLAGS=-std=c11 -O2 -Wall -Wextra -I../../include -I../../../qclean/include
+
+@echo test_fmt: fast formatters vs. printf()...
+gcc %CFLAGS% test_fmt.c -o test_fmt.exe
+@if errorlevel 1 exit /b 1
+test_fmt.exe
+@if errorlevel 1 exit /b 1
+
+@echo test_simd: SIMD frame scanner vs. scalar reference...
+gcc %CFLAGS% test_simd.c -o test_simd.exe
+@if errorlevel 1 exit /b 1
+test_simd.exe
+@if errorlevel 1 exit /b 1
+
+@echo test_schema: table-driven decoder vs. QSpyRecord_process()...
+gcc %CFLAGS% test_schema.c -o test_schema.exe
+@if errorlevel 1 exit /b 1
+test_schema.exe
+@if errorlevel 1 exit /b 1
+
+@echo all unit tests passed
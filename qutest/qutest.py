@@ -79,6 +79,7 @@ class QUTest:
     _str_failed  = ''
     _str_skipped = ''
     _last_record = ''
+    _last_stats  = None
     _log_file    = None
     _test_start  = 0
 
@@ -164,6 +165,8 @@ class QUTest:
             "poke": self.poke,
             "fill": self.fill,
             "note": self.note,
+            "flight_dump": self.flight_dump,
+            "stats": self.stats,
 
             "SCENARIO": self.SCENARIO, # for BDD (alternative 1)
             "GIVEN": self.GIVEN,       # for BDD (alternative 1)
@@ -813,6 +816,26 @@ class QUTest:
         if (dest & QUTest._OPT_TRACE) != 0:
             QSpy.qspy_show(msg, kind=0x0)
 
+    # flight_dump DSL command ..............................................
+    def flight_dump(self):
+        if self._to_skip > 0:
+            return
+        QSpy.qspy_flight_dump()
+
+    # stats DSL command ....................................................
+    # polls the decoder statistics of QSPY and returns them as a dictionary
+    # (see QSpy.unpack_stats()), or None on timeout.
+    # NOTE: the Target output received while waiting is discarded
+    def stats(self):
+        if self._to_skip > 0:
+            return None
+        QUTest._last_stats = None
+        QSpy.qspy_stats()
+        while QUTest._last_stats is None:
+            if not QSpy.receive(): # timeout?
+                break
+        return QUTest._last_stats
+
     # GIVEN DSL command .....................................................
     def GIVEN(self, msg="", dest=0x3):
         self.note(f"\n   GIVEN: {msg}")
@@ -1233,6 +1256,7 @@ class QSpy:
     _PKT_ASSERTION   = 69
     _PKT_ATTACH_CONF = 128
     _PKT_DETACH      = 129
+    _PKT_STATS       = 143
 
     # records directly to the Target...
     TO_TRG_INFO       = 0
@@ -1270,6 +1294,8 @@ class QSpy:
     _QSPY_SEQUENCE_OUT    = 134
     _QSPY_CLEAR_SCREEN    = 140
     _QSPY_SHOW_NOTE       = 141
+    _QSPY_FLIGHT_DUMP     = 142
+    _QSPY_STATS           = 143
 
     # gloal filter groups by topic...
     GRP_ALL= 0xF0
@@ -1577,6 +1603,10 @@ class QSpy:
             QUTest._last_record = ""
             QSpy._is_attached = True
 
+        elif rec_id == QSpy._PKT_STATS:
+            QUTest._last_record = ""
+            QUTest._last_stats = QSpy.unpack_stats(packet[2:])
+
         elif rec_id == QSpy._PKT_DETACH:
             QUTest._quithost_exe(0)
             QUTest._last_record = ""
@@ -1627,6 +1657,48 @@ class QSpy:
     def qspy_show(note, kind=0xFF):
         QSpy.send_to(struct.pack("<BB", QSpy._QSPY_SHOW_NOTE, kind), note)
 
+    # dump the flight recorder of QSPY into the .bin and .txt files
+    @staticmethod
+    def qspy_flight_dump():
+        QSpy.send_to(struct.pack("<B", QSpy._QSPY_FLIGHT_DUMP))
+
+    # poll the decoder statistics of QSPY (see unpack_stats())
+    @staticmethod
+    def qspy_stats():
+        QSpy.send_to(struct.pack("<B", QSpy._QSPY_STATS))
+
+    # decode the payload of the QSPY_STATS packet (little-endian) into a
+    # dictionary with the counters of QSpyStats_pack(), where "recs" maps
+    # the record IDs to (count, bytes), followed by the "pools" of
+    # QSpyPools_pack() (empty if QSPY had no room for them)
+    @staticmethod
+    def unpack_stats(data):
+        fmt = "<QQIIIIIIIH"
+        offset = struct.calcsize(fmt)
+        if len(data) < offset:
+            raise RuntimeError("Corrupted QSPY statistics")
+        fields = struct.unpack_from(fmt, data, 0)
+        stats = dict(zip(("nBytes", "nRecs", "nBadChksum", "nDiscont",
+                          "nLost", "nTooLong", "nTooShort",
+                          "byteRate", "recRate"), fields))
+        n_ids = fields[-1]
+        stats["recs"] = {}
+        for _ in range(n_ids):
+            rec_id, count, nbytes = struct.unpack_from("<BQQ", data, offset)
+            stats["recs"][rec_id] = (count, nbytes)
+            offset += struct.calcsize("<BQQ")
+        stats["pools"] = []
+        if offset + 2 <= len(data): # the pools follow?
+            n_pools = struct.unpack_from("<H", data, offset)[0]
+            offset += 2
+            for _ in range(n_pools):
+                stats["pools"].append(dict(zip(
+                    ("pool", "capacity", "nFree", "nMin",
+                     "nGets", "nFails", "evtSize"),
+                    struct.unpack_from("<QHHHIIH", data, offset))))
+                offset += struct.calcsize("<QHHHIIH")
+        return stats
+
 #=============================================================================
 # main entry point to QUTest
 def main():
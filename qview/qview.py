@@ -185,6 +185,11 @@ class QView:
     def on_run(self):
         pass
 
+    # on_stats() callback with the decoded statistics of QSPY
+    # @sa QView.stats(), QSpy._unpackStats()
+    def on_stats(self, stats):
+        pass
+
     ## @brief Send the RESET packet to the Target
     @staticmethod
     def reset_target():
@@ -205,6 +210,19 @@ class QView:
                              0, param1, param2, param3),
                 cmd_id) # add string command ID to end
 
+    ## @brief dumps the flight recorder of QSPY into the .bin and .txt files
+    # @sa qutest_dsl.flight_dump()
+    @staticmethod
+    def flight_dump():
+        QSpy._sendTo(pack("<B", QSpy._QSPY_FLIGHT_DUMP))
+
+    ## @brief polls the decoder statistics of QSPY, which are delivered
+    # to the on_stats() callback
+    # @sa qutest_dsl.stats()
+    @staticmethod
+    def stats():
+        QSpy._sendTo(pack("<B", QSpy._QSPY_STATS))
+
     ## @brief trigger system clock tick in the Target
     # @sa qutest_dsl.tick()
     @staticmethod
@@ -606,6 +624,8 @@ class QView:
         m.add_command(label="Command...", command=QView._CommandDialog)
         m.add_command(label="Show Note...", command=QView._NoteDialog)
         m.add_command(label="Clear QSPY Screen", command=QView._onClearQspy)
+        m.add_command(label="Dump QSPY Flight Recorder",
+                      command=QView.flight_dump)
         m.add_separator()
         m.add_command(label="Peek...", command=QView._PeekDialog)
         m.add_command(label="Poke...", command=QView._PokeDialog)
@@ -1731,6 +1751,7 @@ class QSpy:
     _PKT_QF_RUN      = 70
     _PKT_ATTACH_CONF = 128
     _PKT_DETACH      = 129
+    _PKT_STATS       = 143
 
     # records to the Target...
     _TRGT_INFO       = 0
@@ -1761,6 +1782,8 @@ class QSpy:
     _QSPY_SEQUENCE_OUT    = 134
     _QSPY_CLEAR_SCREEN    = 140
     _QSPY_SHOW_NOTE       = 141
+    _QSPY_FLIGHT_DUMP     = 142
+    _QSPY_STATS           = 143
 
     # packets to QSpy to be "massaged" and forwarded to the Target...
     _QSPY_SEND_EVENT      = 135
@@ -1970,6 +1993,15 @@ class QSpy:
                     QView._quit(-3)
                     return
 
+            elif recID == QSpy._PKT_STATS:
+                try:
+                    QView._inst.on_stats(QSpy._unpackStats(packet[2:]))
+                except Exception:
+                    QView._showerror("Runtime Error",
+                                        traceback.format_exc(3))
+                    QView._quit(-3)
+                    return
+
             elif recID == QSpy._PKT_DETACH:
                 QView._showerror("UDP Socket Data Error",
                                  "QSPY detached")
@@ -2009,6 +2041,38 @@ class QSpy:
         if not QView._gui is None:
             QView._tx.configure(text=f"{QSpy._tx_seq}")
 
+    # decode the payload of the QSPY_STATS packet (little-endian) into a
+    # dictionary with the counters of QSpyStats_pack(), where "recs" maps
+    # the record IDs to (count, bytes), followed by the "pools" of
+    # QSpyPools_pack() (empty if QSPY had no room for them)
+    @staticmethod
+    def _unpackStats(data):
+        fmt = "<QQIIIIIIIH"
+        offset = struct.calcsize(fmt)
+        if len(data) < offset:
+            raise RuntimeError("Corrupted QSPY statistics")
+        fields = struct.unpack_from(fmt, data, 0)
+        stats = dict(zip(("nBytes", "nRecs", "nBadChksum", "nDiscont",
+                          "nLost", "nTooLong", "nTooShort",
+                          "byteRate", "recRate"), fields))
+        nIds = fields[-1]
+        stats["recs"] = {}
+        for _ in range(nIds):
+            recID, count, nbytes = struct.unpack_from("<BQQ", data, offset)
+            stats["recs"][recID] = (count, nbytes)
+            offset += struct.calcsize("<BQQ")
+        stats["pools"] = []
+        if offset + 2 <= len(data): # the pools follow?
+            nPools = struct.unpack_from("<H", data, offset)[0]
+            offset += 2
+            for _ in range(nPools):
+                stats["pools"].append(dict(zip(
+                    ("pool", "capacity", "nFree", "nMin",
+                     "nGets", "nFails", "evtSize"),
+                    struct.unpack_from("<QHHHIIH", data, offset))))
+                offset += struct.calcsize("<QHHHIIH")
+        return stats
+
     @staticmethod
     def _sendEvt(ao_prio, signal, params = None):
         #print("evt:", signal, params)